@@ -0,0 +1,92 @@
+#ifndef ColumnSpan_h
+#define ColumnSpan_h
+
+
+#include <Rcpp.h>
+#include "NaPolicy.h"
+// [[Rcpp::plugins("cpp11")]]
+
+
+// A non-owning view of a contiguous range of a vector (for example the
+// values or row indices of one column of a dgCMatrix). It is just a pointer
+// and a length, the iterators are plain pointers. Creating a span does not
+// touch the R API, so it can be used from worker threads. The caller is
+// responsible for keeping the underlying vector alive.
+// The na_policy describes if the span can contain NA's (see NaPolicy.h).
+template<typename T, NaPolicy na_policy = NaPolicy::Propagate>
+class ColumnSpan {
+  const T* ptr;
+  R_len_t size_m;
+public:
+  typedef T stored_type;
+  typedef const T* iterator;
+  static constexpr NaPolicy policy = na_policy;
+
+  ColumnSpan(const T* ptr_, R_len_t size_): ptr(ptr_), size_m(size_) {}
+
+  iterator begin() const { return ptr; }
+  iterator end() const { return ptr + size_m; }
+
+  R_len_t size() const { return size_m; }
+
+  bool is_empty() const {
+    return size_m == 0;
+  }
+
+  const T& operator[](R_len_t i) const {
+    return ptr[i];
+  }
+
+};
+
+
+
+// A non-owning, writable view of one column (or row) of a result matrix.
+// Consecutive elements are stride apart, so the same kernel can fill a
+// column of the result (stride = 1) or a row of it (stride = nrow(result)).
+// Like ColumnSpan, it does not touch the R API.
+template<typename T>
+class OutputSpan {
+  T* ptr;
+  R_len_t size_m;
+  R_xlen_t stride;
+public:
+  typedef T stored_type;
+
+  OutputSpan(T* ptr_, R_len_t size_, R_xlen_t stride_ = 1): ptr(ptr_), size_m(size_), stride(stride_) {}
+
+  R_len_t size() const { return size_m; }
+
+  T& operator[](R_len_t i) const {
+    return ptr[(R_xlen_t) i * stride];
+  }
+
+  void fill(T value) const {
+    for(R_len_t i = 0; i < size_m; ++i){
+      ptr[(R_xlen_t) i * stride] = value;
+    }
+  }
+
+};
+
+
+
+// Collects the non-zero results of one or more columns of a sparse result
+// (see reduce_matrix_sparse_matrix() in methods.cpp). The rows of a column
+// have to be pushed in increasing order. NA's and NaN's are kept.
+struct SparseOutput {
+  std::vector<int> row_indices;
+  std::vector<double> values;
+
+  size_t size() const { return values.size(); }
+
+  void push(int row, double value){
+    if(value != 0){
+      row_indices.push_back(row);
+      values.push_back(value);
+    }
+  }
+};
+
+
+#endif /* ColumnSpan_h */
@@ -2,80 +2,118 @@
 #define ColumnView_h
 
 #include <Rcpp.h>
+#include <vector>
 #include "SparseMatrixView.h"
-#include "VectorSubsetView.h"
+#include "ColumnSpan.h"
+#include "NaPolicy.h"
 
 
-class ColumnView {
-  const dgCMatrixView* matrix;
+// The columns of a SparseMatrixView as spans of the values and row indices.
+// The values have the type of the x slot (double or int for a logical
+// matrix).
+template<int RTYPE>
+class SparseColumnView {
+  typedef typename SparseMatrixView<RTYPE>::value_type value_type;
+  const SparseMatrixView<RTYPE>* matrix;
 
 public:
+  template<NaPolicy na_policy>
   class col_container {
   public:
-    VectorSubsetView<REALSXP> values;
-    VectorSubsetView<INTSXP> row_indices;
+    ColumnSpan<value_type, na_policy> values;
+    ColumnSpan<int, na_policy> row_indices;
     const R_len_t number_of_zeros;
 
-    col_container(VectorSubsetView<REALSXP> values_, VectorSubsetView<INTSXP> row_indices_, R_len_t number_of_zeros_):
+    col_container(ColumnSpan<value_type, na_policy> values_, ColumnSpan<int, na_policy> row_indices_, R_len_t number_of_zeros_):
       values(values_), row_indices(row_indices_), number_of_zeros(number_of_zeros_) {}
   };
 
-
-  class iterator {
-    ColumnView* cv;
-    int index;
-  public:
-    using iterator_category= std::input_iterator_tag;
-    using value_type = col_container;
-    using reference = col_container&;
-    using pointer = col_container*;
-    using difference_type = void;
-
-    iterator(ColumnView* cv_): cv(cv_), index(0) {
-      if(cv != nullptr && cv->matrix->ncol == 0){
-        cv = nullptr;
-      }
-    }
-
-    col_container operator*() const {
-      int start_pos = cv->matrix->col_ptrs[index];
-      int end_pos = cv->matrix->col_ptrs[index + 1];
-      int number_of_zeros = cv->matrix->nrow - (end_pos - start_pos);
-      VectorSubsetView<REALSXP> values(cv->matrix->values, start_pos, end_pos);
-      VectorSubsetView<INTSXP> row_indices(cv->matrix->row_indices, start_pos, end_pos);
-
-      return col_container(values, row_indices, number_of_zeros);
+private:
+  template<NaPolicy na_policy>
+  col_container<na_policy> make_column(R_len_t index) const {
+    R_xlen_t start_pos = matrix->col_begin(index);
+    R_len_t size = matrix->col_end(index) - start_pos;
+    if(matrix->has_row_filter()){
+      return filter_rows<na_policy>(start_pos, size);
     }
-
-    iterator& operator++(){ // preincrement
-      ++index;
-      if(index == cv->matrix->ncol)
-        cv=nullptr;
-      return *this;
+    R_len_t number_of_zeros = matrix->nrow - size;
+    ColumnSpan<value_type, na_policy> values(matrix->values_ptr + start_pos, size);
+    ColumnSpan<int, na_policy> row_indices(matrix->row_indices_ptr + start_pos, size);
+    return col_container<na_policy>(values, row_indices, number_of_zeros);
+  }
+
+  // Copy the elements of the selected rows (with the row indices of the view)
+  // into a per-thread buffer, which stays valid until the next call to
+  // column() on the same thread.
+  template<NaPolicy na_policy>
+  col_container<na_policy> filter_rows(R_xlen_t start_pos, R_len_t size) const {
+    thread_local std::vector<value_type> value_buffer;
+    thread_local std::vector<int> row_index_buffer;
+    value_buffer.clear();
+    row_index_buffer.clear();
+    for(R_xlen_t i = start_pos; i < start_pos + size; ++i){
+      int row = matrix->view_row(matrix->row_indices_ptr[i]);
+      if(row >= 0){
+        value_buffer.push_back(matrix->values_ptr[i]);
+        row_index_buffer.push_back(row);
+      }
     }
+    R_len_t filtered_size = value_buffer.size();
+    return col_container<na_policy>(ColumnSpan<value_type, na_policy>(value_buffer.data(), filtered_size),
+                                    ColumnSpan<int, na_policy>(row_index_buffer.data(), filtered_size),
+                                    matrix->nrow - filtered_size);
+  }
 
-    friend bool operator==(iterator const& lhs,iterator const& rhs){
-      return lhs.cv == rhs.cv;
+public:
+  SparseColumnView(const SparseMatrixView<RTYPE>* matrix_): matrix(matrix_) {}
+
+  // Random access to a single column. Only uses the raw pointers of the
+  // matrix, so it can be called from worker threads.
+  col_container<NaPolicy::Propagate> operator[](R_len_t index) const {
+    return make_column<NaPolicy::Propagate>(index);
+  }
+
+  col_container<NaPolicy::Propagate> column(R_len_t index, na_policy_tag<NaPolicy::Propagate>) const {
+    return make_column<NaPolicy::Propagate>(index);
+  }
+
+  col_container<NaPolicy::AssumeNone> column(R_len_t index, na_policy_tag<NaPolicy::AssumeNone>) const {
+    return make_column<NaPolicy::AssumeNone>(index);
+  }
+
+  // Remove the NA's (and the corresponding row indices) from the column. If the
+  // column does contain NA's, the remaining elements are copied into a per-thread
+  // buffer, which stays valid until the next call to column() on the same thread.
+  col_container<NaPolicy::Skip> column(R_len_t index, na_policy_tag<NaPolicy::Skip>) const {
+    col_container<NaPolicy::Skip> col = make_column<NaPolicy::Skip>(index);
+    const value_type* first_na = std::find_if(col.values.begin(), col.values.end(), [](const value_type d) -> bool {
+      return is_na_value(d);
+    });
+    if(first_na == col.values.end()){
+      return col;
     }
-    friend bool operator!=(iterator const& lhs,iterator const& rhs){
-      return !(lhs==rhs);
+    thread_local std::vector<value_type> value_buffer;
+    thread_local std::vector<int> row_index_buffer;
+    value_buffer.clear();
+    row_index_buffer.clear();
+    R_len_t offset = first_na - col.values.begin();
+    value_buffer.insert(value_buffer.end(), col.values.begin(), first_na);
+    row_index_buffer.insert(row_index_buffer.end(), col.row_indices.begin(), col.row_indices.begin() + offset);
+    for(R_len_t i = offset + 1; i < col.values.size(); ++i){
+      if(! is_na_value(col.values[i])){
+        value_buffer.push_back(col.values[i]);
+        row_index_buffer.push_back(col.row_indices[i]);
+      }
     }
-
-  };
-
-  ColumnView(dgCMatrixView* matrix_): matrix(matrix_) {}
-  iterator begin() { return iterator(this); }
-  iterator end() { return iterator(nullptr); }
+    R_len_t size = value_buffer.size();
+    return col_container<NaPolicy::Skip>(ColumnSpan<value_type, NaPolicy::Skip>(value_buffer.data(), size),
+                                         ColumnSpan<int, NaPolicy::Skip>(row_index_buffer.data(), size),
+                                         col.number_of_zeros);
+  }
 
 };
 
-
-
-
-
-
-
-
+typedef SparseColumnView<REALSXP> ColumnView;
 
 
 
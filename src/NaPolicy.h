@@ -0,0 +1,77 @@
+#ifndef NaPolicy_h
+#define NaPolicy_h
+
+#include <Rcpp.h>
+#include <type_traits>
+#include "SparseMatrixView.h"
+
+
+// How the kernels have to deal with missing values. The policy is a
+// compile-time property of the column that a kernel gets, so that the
+// NA checks disappear from the kernels that cannot see an NA.
+//  * Propagate: the column can contain NA's, the kernel has to handle them
+//  * Skip: the NA's have been removed from the column (na.rm = TRUE)
+//  * AssumeNone: the matrix does not contain a single NA
+enum class NaPolicy { Propagate, Skip, AssumeNone };
+
+template<NaPolicy na_policy>
+using na_policy_tag = std::integral_constant<NaPolicy, na_policy>;
+
+
+// NA test for the values of a double or a logical / integer slot
+inline bool is_na_value(double d){
+  return ISNAN(d);
+}
+
+inline bool is_na_value(int i){
+  return i == NA_INTEGER;
+}
+
+// A value of a double or a logical / integer slot as double (with NA_REAL for NA)
+inline double as_double_value(double d){
+  return d;
+}
+
+inline double as_double_value(int i){
+  return i == NA_INTEGER ? NA_REAL : (double) i;
+}
+
+
+template<int RTYPE>
+bool matrix_has_na(const SparseMatrixView<RTYPE>& sp_mat){
+  typedef typename SparseMatrixView<RTYPE>::value_type value_type;
+  auto is_na = [](const value_type d) -> bool {
+    return is_na_value(d);
+  };
+  if(sp_mat.col_subset_ptr == nullptr){
+    const value_type* begin = sp_mat.values_ptr;
+    const value_type* end = begin + sp_mat.stored_size();
+    return std::any_of(begin, end, is_na);
+  }
+  // Only the selected columns (ignoring the row filter, an NA in a row that is
+  // not selected merely picks a slower policy)
+  for(R_len_t col = 0; col < sp_mat.ncol; ++col){
+    if(std::any_of(sp_mat.values_ptr + sp_mat.col_begin(col), sp_mat.values_ptr + sp_mat.col_end(col), is_na)){
+      return true;
+    }
+  }
+  return false;
+}
+
+
+// Pick the NA policy at runtime and call op with the corresponding tag.
+// If a quick scan over all values does not find a single NA, the kernels
+// are instantiated without any NA handling.
+template<int RTYPE, typename Functor>
+void dispatch_na_policy(const SparseMatrixView<RTYPE>& sp_mat, bool na_rm, Functor op){
+  if(! matrix_has_na(sp_mat)){
+    op(na_policy_tag<NaPolicy::AssumeNone>());
+  }else if(na_rm){
+    op(na_policy_tag<NaPolicy::Skip>());
+  }else{
+    op(na_policy_tag<NaPolicy::Propagate>());
+  }
+}
+
+
+#endif /* NaPolicy_h */
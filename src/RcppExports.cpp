@@ -6,57 +6,107 @@
 using namespace Rcpp;
 
 // dgCMatrix_colSums2
-NumericVector dgCMatrix_colSums2(S4 matrix, bool na_rm);
-RcppExport SEXP _sparseMatrixStats_dgCMatrix_colSums2(SEXP matrixSEXP, SEXP na_rmSEXP) {
+NumericVector dgCMatrix_colSums2(S4 matrix, bool na_rm, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_colSums2(SEXP matrixSEXP, SEXP na_rmSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
     Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
-    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colSums2(matrix, na_rm));
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colSums2(matrix, na_rm, rows, cols));
     return rcpp_result_gen;
 END_RCPP
 }
 // dgCMatrix_colMeans2
-NumericVector dgCMatrix_colMeans2(S4 matrix, bool na_rm);
-RcppExport SEXP _sparseMatrixStats_dgCMatrix_colMeans2(SEXP matrixSEXP, SEXP na_rmSEXP) {
+NumericVector dgCMatrix_colMeans2(S4 matrix, bool na_rm, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_colMeans2(SEXP matrixSEXP, SEXP na_rmSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
     Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
-    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colMeans2(matrix, na_rm));
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colMeans2(matrix, na_rm, rows, cols));
     return rcpp_result_gen;
 END_RCPP
 }
 // dgCMatrix_colMedians
-NumericVector dgCMatrix_colMedians(S4 matrix, bool na_rm);
-RcppExport SEXP _sparseMatrixStats_dgCMatrix_colMedians(SEXP matrixSEXP, SEXP na_rmSEXP) {
+NumericVector dgCMatrix_colMedians(S4 matrix, bool na_rm, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_colMedians(SEXP matrixSEXP, SEXP na_rmSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
     Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
-    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colMedians(matrix, na_rm));
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colMedians(matrix, na_rm, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_rowMedians
+NumericVector dgCMatrix_rowMedians(S4 matrix, bool na_rm, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowMedians(SEXP matrixSEXP, SEXP na_rmSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowMedians(matrix, na_rm, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_colIQRs
+NumericVector dgCMatrix_colIQRs(S4 matrix, bool na_rm, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_colIQRs(SEXP matrixSEXP, SEXP na_rmSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colIQRs(matrix, na_rm, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_rowIQRs
+NumericVector dgCMatrix_rowIQRs(S4 matrix, bool na_rm, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowIQRs(SEXP matrixSEXP, SEXP na_rmSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowIQRs(matrix, na_rm, rows, cols));
     return rcpp_result_gen;
 END_RCPP
 }
 // dgCMatrix_colVars
-NumericVector dgCMatrix_colVars(S4 matrix, bool na_rm, Nullable<NumericVector> center);
-RcppExport SEXP _sparseMatrixStats_dgCMatrix_colVars(SEXP matrixSEXP, SEXP na_rmSEXP, SEXP centerSEXP) {
+NumericVector dgCMatrix_colVars(S4 matrix, bool na_rm, Nullable<NumericVector> center, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_colVars(SEXP matrixSEXP, SEXP na_rmSEXP, SEXP centerSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
     Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
     Rcpp::traits::input_parameter< Nullable<NumericVector> >::type center(centerSEXP);
-    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colVars(matrix, na_rm, center));
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colVars(matrix, na_rm, center, rows, cols));
     return rcpp_result_gen;
 END_RCPP
 }
 // dgCMatrix_colMads
-NumericVector dgCMatrix_colMads(S4 matrix, bool na_rm, double scale_factor, Nullable<NumericVector> center);
-RcppExport SEXP _sparseMatrixStats_dgCMatrix_colMads(SEXP matrixSEXP, SEXP na_rmSEXP, SEXP scale_factorSEXP, SEXP centerSEXP) {
+NumericVector dgCMatrix_colMads(S4 matrix, bool na_rm, double scale_factor, Nullable<NumericVector> center, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_colMads(SEXP matrixSEXP, SEXP na_rmSEXP, SEXP scale_factorSEXP, SEXP centerSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -64,157 +114,468 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
     Rcpp::traits::input_parameter< double >::type scale_factor(scale_factorSEXP);
     Rcpp::traits::input_parameter< Nullable<NumericVector> >::type center(centerSEXP);
-    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colMads(matrix, na_rm, scale_factor, center));
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colMads(matrix, na_rm, scale_factor, center, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_rowMads
+NumericVector dgCMatrix_rowMads(S4 matrix, bool na_rm, double scale_factor, Nullable<NumericVector> center, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowMads(SEXP matrixSEXP, SEXP na_rmSEXP, SEXP scale_factorSEXP, SEXP centerSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
+    Rcpp::traits::input_parameter< double >::type scale_factor(scale_factorSEXP);
+    Rcpp::traits::input_parameter< Nullable<NumericVector> >::type center(centerSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowMads(matrix, na_rm, scale_factor, center, rows, cols));
     return rcpp_result_gen;
 END_RCPP
 }
 // dgCMatrix_colMins
-NumericVector dgCMatrix_colMins(S4 matrix, bool na_rm);
-RcppExport SEXP _sparseMatrixStats_dgCMatrix_colMins(SEXP matrixSEXP, SEXP na_rmSEXP) {
+NumericVector dgCMatrix_colMins(S4 matrix, bool na_rm, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_colMins(SEXP matrixSEXP, SEXP na_rmSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
     Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
-    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colMins(matrix, na_rm));
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colMins(matrix, na_rm, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_rowMins
+NumericVector dgCMatrix_rowMins(S4 matrix, bool na_rm, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowMins(SEXP matrixSEXP, SEXP na_rmSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowMins(matrix, na_rm, rows, cols));
     return rcpp_result_gen;
 END_RCPP
 }
 // dgCMatrix_colMaxs
-NumericVector dgCMatrix_colMaxs(S4 matrix, bool na_rm);
-RcppExport SEXP _sparseMatrixStats_dgCMatrix_colMaxs(SEXP matrixSEXP, SEXP na_rmSEXP) {
+NumericVector dgCMatrix_colMaxs(S4 matrix, bool na_rm, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_colMaxs(SEXP matrixSEXP, SEXP na_rmSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colMaxs(matrix, na_rm, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_rowMaxs
+NumericVector dgCMatrix_rowMaxs(S4 matrix, bool na_rm, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowMaxs(SEXP matrixSEXP, SEXP na_rmSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
     Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
-    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colMaxs(matrix, na_rm));
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowMaxs(matrix, na_rm, rows, cols));
     return rcpp_result_gen;
 END_RCPP
 }
 // dgCMatrix_colOrderStats
-NumericVector dgCMatrix_colOrderStats(S4 matrix, int which, bool na_rm);
-RcppExport SEXP _sparseMatrixStats_dgCMatrix_colOrderStats(SEXP matrixSEXP, SEXP whichSEXP, SEXP na_rmSEXP) {
+NumericVector dgCMatrix_colOrderStats(S4 matrix, int which, bool na_rm, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_colOrderStats(SEXP matrixSEXP, SEXP whichSEXP, SEXP na_rmSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
     Rcpp::traits::input_parameter< int >::type which(whichSEXP);
     Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
-    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colOrderStats(matrix, which, na_rm));
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colOrderStats(matrix, which, na_rm, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_rowOrderStats
+NumericVector dgCMatrix_rowOrderStats(S4 matrix, int which, bool na_rm, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowOrderStats(SEXP matrixSEXP, SEXP whichSEXP, SEXP na_rmSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< int >::type which(whichSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowOrderStats(matrix, which, na_rm, rows, cols));
     return rcpp_result_gen;
 END_RCPP
 }
 // dgCMatrix_colLogSumExps
-NumericVector dgCMatrix_colLogSumExps(S4 matrix, bool na_rm);
-RcppExport SEXP _sparseMatrixStats_dgCMatrix_colLogSumExps(SEXP matrixSEXP, SEXP na_rmSEXP) {
+NumericVector dgCMatrix_colLogSumExps(S4 matrix, bool na_rm, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_colLogSumExps(SEXP matrixSEXP, SEXP na_rmSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
     Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
-    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colLogSumExps(matrix, na_rm));
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colLogSumExps(matrix, na_rm, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_rowLogSumExps
+NumericVector dgCMatrix_rowLogSumExps(S4 matrix, bool na_rm, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowLogSumExps(SEXP matrixSEXP, SEXP na_rmSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowLogSumExps(matrix, na_rm, rows, cols));
     return rcpp_result_gen;
 END_RCPP
 }
 // dgCMatrix_colProds
-NumericVector dgCMatrix_colProds(S4 matrix, bool na_rm);
-RcppExport SEXP _sparseMatrixStats_dgCMatrix_colProds(SEXP matrixSEXP, SEXP na_rmSEXP) {
+NumericVector dgCMatrix_colProds(S4 matrix, bool na_rm, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_colProds(SEXP matrixSEXP, SEXP na_rmSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colProds(matrix, na_rm, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_rowProds
+NumericVector dgCMatrix_rowProds(S4 matrix, bool na_rm, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowProds(SEXP matrixSEXP, SEXP na_rmSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowProds(matrix, na_rm, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_colSummary
+NumericMatrix dgCMatrix_colSummary(S4 matrix, bool na_rm, CharacterVector stats, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_colSummary(SEXP matrixSEXP, SEXP na_rmSEXP, SEXP statsSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
     Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
-    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colProds(matrix, na_rm));
+    Rcpp::traits::input_parameter< CharacterVector >::type stats(statsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colSummary(matrix, na_rm, stats, rows, cols));
     return rcpp_result_gen;
 END_RCPP
 }
 // dgCMatrix_colWeightedMeans
-NumericVector dgCMatrix_colWeightedMeans(S4 matrix, NumericVector weights, bool na_rm);
-RcppExport SEXP _sparseMatrixStats_dgCMatrix_colWeightedMeans(SEXP matrixSEXP, SEXP weightsSEXP, SEXP na_rmSEXP) {
+NumericVector dgCMatrix_colWeightedMeans(S4 matrix, NumericVector weights, bool na_rm, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_colWeightedMeans(SEXP matrixSEXP, SEXP weightsSEXP, SEXP na_rmSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
     Rcpp::traits::input_parameter< NumericVector >::type weights(weightsSEXP);
     Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
-    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colWeightedMeans(matrix, weights, na_rm));
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colWeightedMeans(matrix, weights, na_rm, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_rowWeightedMeans
+NumericVector dgCMatrix_rowWeightedMeans(S4 matrix, NumericVector weights, bool na_rm, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowWeightedMeans(SEXP matrixSEXP, SEXP weightsSEXP, SEXP na_rmSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type weights(weightsSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowWeightedMeans(matrix, weights, na_rm, rows, cols));
     return rcpp_result_gen;
 END_RCPP
 }
 // dgCMatrix_colWeightedVars
-NumericVector dgCMatrix_colWeightedVars(S4 matrix, NumericVector weights, bool na_rm);
-RcppExport SEXP _sparseMatrixStats_dgCMatrix_colWeightedVars(SEXP matrixSEXP, SEXP weightsSEXP, SEXP na_rmSEXP) {
+NumericVector dgCMatrix_colWeightedVars(S4 matrix, NumericVector weights, bool na_rm, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_colWeightedVars(SEXP matrixSEXP, SEXP weightsSEXP, SEXP na_rmSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type weights(weightsSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colWeightedVars(matrix, weights, na_rm, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_rowWeightedVars
+NumericVector dgCMatrix_rowWeightedVars(S4 matrix, NumericVector weights, bool na_rm, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowWeightedVars(SEXP matrixSEXP, SEXP weightsSEXP, SEXP na_rmSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
     Rcpp::traits::input_parameter< NumericVector >::type weights(weightsSEXP);
     Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
-    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colWeightedVars(matrix, weights, na_rm));
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowWeightedVars(matrix, weights, na_rm, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_colWeightedMedians
+NumericVector dgCMatrix_colWeightedMedians(S4 matrix, NumericVector weights, bool na_rm, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_colWeightedMedians(SEXP matrixSEXP, SEXP weightsSEXP, SEXP na_rmSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type weights(weightsSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colWeightedMedians(matrix, weights, na_rm, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_rowWeightedMedians
+NumericVector dgCMatrix_rowWeightedMedians(S4 matrix, NumericVector weights, bool na_rm, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowWeightedMedians(SEXP matrixSEXP, SEXP weightsSEXP, SEXP na_rmSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type weights(weightsSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowWeightedMedians(matrix, weights, na_rm, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_colWeightedMads
+NumericVector dgCMatrix_colWeightedMads(S4 matrix, NumericVector weights, bool na_rm, double scale_factor, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_colWeightedMads(SEXP matrixSEXP, SEXP weightsSEXP, SEXP na_rmSEXP, SEXP scale_factorSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type weights(weightsSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
+    Rcpp::traits::input_parameter< double >::type scale_factor(scale_factorSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colWeightedMads(matrix, weights, na_rm, scale_factor, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_rowWeightedMads
+NumericVector dgCMatrix_rowWeightedMads(S4 matrix, NumericVector weights, bool na_rm, double scale_factor, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowWeightedMads(SEXP matrixSEXP, SEXP weightsSEXP, SEXP na_rmSEXP, SEXP scale_factorSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type weights(weightsSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
+    Rcpp::traits::input_parameter< double >::type scale_factor(scale_factorSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowWeightedMads(matrix, weights, na_rm, scale_factor, rows, cols));
     return rcpp_result_gen;
 END_RCPP
 }
 // dgCMatrix_colCounts
-IntegerVector dgCMatrix_colCounts(S4 matrix, double value, bool na_rm);
-RcppExport SEXP _sparseMatrixStats_dgCMatrix_colCounts(SEXP matrixSEXP, SEXP valueSEXP, SEXP na_rmSEXP) {
+IntegerVector dgCMatrix_colCounts(S4 matrix, double value, bool na_rm, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_colCounts(SEXP matrixSEXP, SEXP valueSEXP, SEXP na_rmSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
     Rcpp::traits::input_parameter< double >::type value(valueSEXP);
     Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
-    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colCounts(matrix, value, na_rm));
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colCounts(matrix, value, na_rm, rows, cols));
     return rcpp_result_gen;
 END_RCPP
 }
 // dgCMatrix_colAnyNAs
-LogicalVector dgCMatrix_colAnyNAs(S4 matrix);
-RcppExport SEXP _sparseMatrixStats_dgCMatrix_colAnyNAs(SEXP matrixSEXP) {
+LogicalVector dgCMatrix_colAnyNAs(S4 matrix, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_colAnyNAs(SEXP matrixSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
-    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colAnyNAs(matrix));
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colAnyNAs(matrix, rows, cols));
     return rcpp_result_gen;
 END_RCPP
 }
 // dgCMatrix_colAnys
-LogicalVector dgCMatrix_colAnys(S4 matrix, double value, bool na_rm);
-RcppExport SEXP _sparseMatrixStats_dgCMatrix_colAnys(SEXP matrixSEXP, SEXP valueSEXP, SEXP na_rmSEXP) {
+LogicalVector dgCMatrix_colAnys(S4 matrix, double value, bool na_rm, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_colAnys(SEXP matrixSEXP, SEXP valueSEXP, SEXP na_rmSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
     Rcpp::traits::input_parameter< double >::type value(valueSEXP);
     Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
-    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colAnys(matrix, value, na_rm));
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colAnys(matrix, value, na_rm, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_rowAnys
+LogicalVector dgCMatrix_rowAnys(S4 matrix, double value, bool na_rm, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowAnys(SEXP matrixSEXP, SEXP valueSEXP, SEXP na_rmSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< double >::type value(valueSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowAnys(matrix, value, na_rm, rows, cols));
     return rcpp_result_gen;
 END_RCPP
 }
 // dgCMatrix_colAlls
-LogicalVector dgCMatrix_colAlls(S4 matrix, double value, bool na_rm);
-RcppExport SEXP _sparseMatrixStats_dgCMatrix_colAlls(SEXP matrixSEXP, SEXP valueSEXP, SEXP na_rmSEXP) {
+LogicalVector dgCMatrix_colAlls(S4 matrix, double value, bool na_rm, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_colAlls(SEXP matrixSEXP, SEXP valueSEXP, SEXP na_rmSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
     Rcpp::traits::input_parameter< double >::type value(valueSEXP);
     Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
-    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colAlls(matrix, value, na_rm));
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colAlls(matrix, value, na_rm, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_rowAlls
+LogicalVector dgCMatrix_rowAlls(S4 matrix, double value, bool na_rm, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowAlls(SEXP matrixSEXP, SEXP valueSEXP, SEXP na_rmSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< double >::type value(valueSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowAlls(matrix, value, na_rm, rows, cols));
     return rcpp_result_gen;
 END_RCPP
 }
 // dgCMatrix_colQuantiles
-NumericMatrix dgCMatrix_colQuantiles(S4 matrix, NumericVector probs, bool na_rm);
-RcppExport SEXP _sparseMatrixStats_dgCMatrix_colQuantiles(SEXP matrixSEXP, SEXP probsSEXP, SEXP na_rmSEXP) {
+NumericMatrix dgCMatrix_colQuantiles(S4 matrix, NumericVector probs, bool na_rm, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_colQuantiles(SEXP matrixSEXP, SEXP probsSEXP, SEXP na_rmSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
     Rcpp::traits::input_parameter< NumericVector >::type probs(probsSEXP);
     Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
-    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colQuantiles(matrix, probs, na_rm));
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colQuantiles(matrix, probs, na_rm, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_rowQuantiles
+NumericMatrix dgCMatrix_rowQuantiles(S4 matrix, NumericVector probs, bool na_rm, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowQuantiles(SEXP matrixSEXP, SEXP probsSEXP, SEXP na_rmSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type probs(probsSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowQuantiles(matrix, probs, na_rm, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_colQuantilesApprox
+NumericMatrix dgCMatrix_colQuantilesApprox(S4 matrix, NumericVector probs, bool na_rm, double compression, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_colQuantilesApprox(SEXP matrixSEXP, SEXP probsSEXP, SEXP na_rmSEXP, SEXP compressionSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type probs(probsSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
+    Rcpp::traits::input_parameter< double >::type compression(compressionSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colQuantilesApprox(matrix, probs, na_rm, compression, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_colTopK
+List dgCMatrix_colTopK(S4 matrix, int k, bool decreasing, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_colTopK(SEXP matrixSEXP, SEXP kSEXP, SEXP decreasingSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< int >::type k(kSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colTopK(matrix, k, decreasing, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_rowTopK
+List dgCMatrix_rowTopK(S4 matrix, int k, bool decreasing, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowTopK(SEXP matrixSEXP, SEXP kSEXP, SEXP decreasingSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< int >::type k(kSEXP);
+    Rcpp::traits::input_parameter< bool >::type decreasing(decreasingSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowTopK(matrix, k, decreasing, rows, cols));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -231,52 +592,250 @@ BEGIN_RCPP
 END_RCPP
 }
 // dgCMatrix_colCumsums
-NumericMatrix dgCMatrix_colCumsums(S4 matrix);
-RcppExport SEXP _sparseMatrixStats_dgCMatrix_colCumsums(SEXP matrixSEXP) {
+NumericMatrix dgCMatrix_colCumsums(S4 matrix, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_colCumsums(SEXP matrixSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
-    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colCumsums(matrix));
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colCumsums(matrix, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_rowCumsums
+NumericMatrix dgCMatrix_rowCumsums(S4 matrix, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowCumsums(SEXP matrixSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowCumsums(matrix, rows, cols));
     return rcpp_result_gen;
 END_RCPP
 }
 // dgCMatrix_colCumprods
-NumericMatrix dgCMatrix_colCumprods(S4 matrix);
-RcppExport SEXP _sparseMatrixStats_dgCMatrix_colCumprods(SEXP matrixSEXP) {
+NumericMatrix dgCMatrix_colCumprods(S4 matrix, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_colCumprods(SEXP matrixSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
-    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colCumprods(matrix));
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colCumprods(matrix, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_rowCumprods
+NumericMatrix dgCMatrix_rowCumprods(S4 matrix, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowCumprods(SEXP matrixSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowCumprods(matrix, rows, cols));
     return rcpp_result_gen;
 END_RCPP
 }
 // dgCMatrix_colCummins
-NumericMatrix dgCMatrix_colCummins(S4 matrix);
-RcppExport SEXP _sparseMatrixStats_dgCMatrix_colCummins(SEXP matrixSEXP) {
+NumericMatrix dgCMatrix_colCummins(S4 matrix, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_colCummins(SEXP matrixSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
-    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colCummins(matrix));
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colCummins(matrix, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_rowCummins
+NumericMatrix dgCMatrix_rowCummins(S4 matrix, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowCummins(SEXP matrixSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowCummins(matrix, rows, cols));
     return rcpp_result_gen;
 END_RCPP
 }
 // dgCMatrix_colCummaxs
-NumericMatrix dgCMatrix_colCummaxs(S4 matrix);
-RcppExport SEXP _sparseMatrixStats_dgCMatrix_colCummaxs(SEXP matrixSEXP) {
+NumericMatrix dgCMatrix_colCummaxs(S4 matrix, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_colCummaxs(SEXP matrixSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colCummaxs(matrix, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_rowCummaxs
+NumericMatrix dgCMatrix_rowCummaxs(S4 matrix, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowCummaxs(SEXP matrixSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
-    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colCummaxs(matrix));
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowCummaxs(matrix, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_colCumulative_sparse
+S4 dgCMatrix_colCumulative_sparse(S4 matrix, std::string fun, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_colCumulative_sparse(SEXP matrixSEXP, SEXP funSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< std::string >::type fun(funSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colCumulative_sparse(matrix, fun, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_rowCumulative_sparse
+S4 dgCMatrix_rowCumulative_sparse(S4 matrix, std::string fun, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowCumulative_sparse(SEXP matrixSEXP, SEXP funSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< std::string >::type fun(funSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowCumulative_sparse(matrix, fun, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_colDiffs
+NumericMatrix dgCMatrix_colDiffs(S4 matrix, int lag, int differences, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_colDiffs(SEXP matrixSEXP, SEXP lagSEXP, SEXP differencesSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< int >::type lag(lagSEXP);
+    Rcpp::traits::input_parameter< int >::type differences(differencesSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colDiffs(matrix, lag, differences, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_rowDiffs
+NumericMatrix dgCMatrix_rowDiffs(S4 matrix, int lag, int differences, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowDiffs(SEXP matrixSEXP, SEXP lagSEXP, SEXP differencesSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< int >::type lag(lagSEXP);
+    Rcpp::traits::input_parameter< int >::type differences(differencesSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowDiffs(matrix, lag, differences, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_colDiffs_sparse
+S4 dgCMatrix_colDiffs_sparse(S4 matrix, int lag, int differences, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_colDiffs_sparse(SEXP matrixSEXP, SEXP lagSEXP, SEXP differencesSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< int >::type lag(lagSEXP);
+    Rcpp::traits::input_parameter< int >::type differences(differencesSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colDiffs_sparse(matrix, lag, differences, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_rowDiffs_sparse
+S4 dgCMatrix_rowDiffs_sparse(S4 matrix, int lag, int differences, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowDiffs_sparse(SEXP matrixSEXP, SEXP lagSEXP, SEXP differencesSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< int >::type lag(lagSEXP);
+    Rcpp::traits::input_parameter< int >::type differences(differencesSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowDiffs_sparse(matrix, lag, differences, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_colDiffStats
+NumericVector dgCMatrix_colDiffStats(S4 matrix, std::string stat, bool na_rm, int diff, double constant, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_colDiffStats(SEXP matrixSEXP, SEXP statSEXP, SEXP na_rmSEXP, SEXP diffSEXP, SEXP constantSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< std::string >::type stat(statSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
+    Rcpp::traits::input_parameter< int >::type diff(diffSEXP);
+    Rcpp::traits::input_parameter< double >::type constant(constantSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colDiffStats(matrix, stat, na_rm, diff, constant, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_rowDiffStats
+NumericVector dgCMatrix_rowDiffStats(S4 matrix, std::string stat, bool na_rm, int diff, double constant, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowDiffStats(SEXP matrixSEXP, SEXP statSEXP, SEXP na_rmSEXP, SEXP diffSEXP, SEXP constantSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< std::string >::type stat(statSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
+    Rcpp::traits::input_parameter< int >::type diff(diffSEXP);
+    Rcpp::traits::input_parameter< double >::type constant(constantSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowDiffStats(matrix, stat, na_rm, diff, constant, rows, cols));
     return rcpp_result_gen;
 END_RCPP
 }
 // dgCMatrix_colRanks_num
-NumericMatrix dgCMatrix_colRanks_num(S4 matrix, std::string ties_method, std::string na_handling, bool preserve_shape);
-RcppExport SEXP _sparseMatrixStats_dgCMatrix_colRanks_num(SEXP matrixSEXP, SEXP ties_methodSEXP, SEXP na_handlingSEXP, SEXP preserve_shapeSEXP) {
+NumericMatrix dgCMatrix_colRanks_num(S4 matrix, std::string ties_method, std::string na_handling, bool preserve_shape, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_colRanks_num(SEXP matrixSEXP, SEXP ties_methodSEXP, SEXP na_handlingSEXP, SEXP preserve_shapeSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< std::string >::type ties_method(ties_methodSEXP);
+    Rcpp::traits::input_parameter< std::string >::type na_handling(na_handlingSEXP);
+    Rcpp::traits::input_parameter< bool >::type preserve_shape(preserve_shapeSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colRanks_num(matrix, ties_method, na_handling, preserve_shape, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_rowRanks_num
+NumericMatrix dgCMatrix_rowRanks_num(S4 matrix, std::string ties_method, std::string na_handling, bool preserve_shape, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowRanks_num(SEXP matrixSEXP, SEXP ties_methodSEXP, SEXP na_handlingSEXP, SEXP preserve_shapeSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -284,13 +843,15 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< std::string >::type ties_method(ties_methodSEXP);
     Rcpp::traits::input_parameter< std::string >::type na_handling(na_handlingSEXP);
     Rcpp::traits::input_parameter< bool >::type preserve_shape(preserve_shapeSEXP);
-    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colRanks_num(matrix, ties_method, na_handling, preserve_shape));
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowRanks_num(matrix, ties_method, na_handling, preserve_shape, rows, cols));
     return rcpp_result_gen;
 END_RCPP
 }
 // dgCMatrix_colRanks_int
-IntegerMatrix dgCMatrix_colRanks_int(S4 matrix, std::string ties_method, std::string na_handling, bool preserve_shape);
-RcppExport SEXP _sparseMatrixStats_dgCMatrix_colRanks_int(SEXP matrixSEXP, SEXP ties_methodSEXP, SEXP na_handlingSEXP, SEXP preserve_shapeSEXP) {
+IntegerMatrix dgCMatrix_colRanks_int(S4 matrix, std::string ties_method, std::string na_handling, bool preserve_shape, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_colRanks_int(SEXP matrixSEXP, SEXP ties_methodSEXP, SEXP na_handlingSEXP, SEXP preserve_shapeSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -298,7 +859,57 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< std::string >::type ties_method(ties_methodSEXP);
     Rcpp::traits::input_parameter< std::string >::type na_handling(na_handlingSEXP);
     Rcpp::traits::input_parameter< bool >::type preserve_shape(preserve_shapeSEXP);
-    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colRanks_int(matrix, ties_method, na_handling, preserve_shape));
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colRanks_int(matrix, ties_method, na_handling, preserve_shape, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_rowRanks_int
+IntegerMatrix dgCMatrix_rowRanks_int(S4 matrix, std::string ties_method, std::string na_handling, bool preserve_shape, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowRanks_int(SEXP matrixSEXP, SEXP ties_methodSEXP, SEXP na_handlingSEXP, SEXP preserve_shapeSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< std::string >::type ties_method(ties_methodSEXP);
+    Rcpp::traits::input_parameter< std::string >::type na_handling(na_handlingSEXP);
+    Rcpp::traits::input_parameter< bool >::type preserve_shape(preserve_shapeSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowRanks_int(matrix, ties_method, na_handling, preserve_shape, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_colRanks_sparse
+List dgCMatrix_colRanks_sparse(S4 matrix, std::string ties_method, std::string na_handling, bool preserve_shape, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_colRanks_sparse(SEXP matrixSEXP, SEXP ties_methodSEXP, SEXP na_handlingSEXP, SEXP preserve_shapeSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< std::string >::type ties_method(ties_methodSEXP);
+    Rcpp::traits::input_parameter< std::string >::type na_handling(na_handlingSEXP);
+    Rcpp::traits::input_parameter< bool >::type preserve_shape(preserve_shapeSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colRanks_sparse(matrix, ties_method, na_handling, preserve_shape, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_rowRanks_sparse
+List dgCMatrix_rowRanks_sparse(S4 matrix, std::string ties_method, std::string na_handling, bool preserve_shape, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowRanks_sparse(SEXP matrixSEXP, SEXP ties_methodSEXP, SEXP na_handlingSEXP, SEXP preserve_shapeSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< std::string >::type ties_method(ties_methodSEXP);
+    Rcpp::traits::input_parameter< std::string >::type na_handling(na_handlingSEXP);
+    Rcpp::traits::input_parameter< bool >::type preserve_shape(preserve_shapeSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowRanks_sparse(matrix, ties_method, na_handling, preserve_shape, rows, cols));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -316,72 +927,297 @@ BEGIN_RCPP
 END_RCPP
 }
 // dgCMatrix_rowSums2
-NumericVector dgCMatrix_rowSums2(S4 matrix, bool na_rm);
-RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowSums2(SEXP matrixSEXP, SEXP na_rmSEXP) {
+NumericVector dgCMatrix_rowSums2(S4 matrix, bool na_rm, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowSums2(SEXP matrixSEXP, SEXP na_rmSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
     Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
-    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowSums2(matrix, na_rm));
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowSums2(matrix, na_rm, rows, cols));
     return rcpp_result_gen;
 END_RCPP
 }
 // dgCMatrix_rowMeans2
-NumericVector dgCMatrix_rowMeans2(S4 matrix, bool na_rm);
-RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowMeans2(SEXP matrixSEXP, SEXP na_rmSEXP) {
+NumericVector dgCMatrix_rowMeans2(S4 matrix, bool na_rm, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowMeans2(SEXP matrixSEXP, SEXP na_rmSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
     Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
-    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowMeans2(matrix, na_rm));
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowMeans2(matrix, na_rm, rows, cols));
     return rcpp_result_gen;
 END_RCPP
 }
 // dgCMatrix_rowVars
-NumericVector dgCMatrix_rowVars(S4 matrix, bool na_rm, Nullable<NumericVector> center);
-RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowVars(SEXP matrixSEXP, SEXP na_rmSEXP, SEXP centerSEXP) {
+NumericVector dgCMatrix_rowVars(S4 matrix, bool na_rm, Nullable<NumericVector> center, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowVars(SEXP matrixSEXP, SEXP na_rmSEXP, SEXP centerSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
     Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
     Rcpp::traits::input_parameter< Nullable<NumericVector> >::type center(centerSEXP);
-    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowVars(matrix, na_rm, center));
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowVars(matrix, na_rm, center, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_rowCounts
+IntegerVector dgCMatrix_rowCounts(S4 matrix, double value, bool na_rm, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowCounts(SEXP matrixSEXP, SEXP valueSEXP, SEXP na_rmSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< double >::type value(valueSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowCounts(matrix, value, na_rm, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_rowAnyNAs
+LogicalVector dgCMatrix_rowAnyNAs(S4 matrix, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowAnyNAs(SEXP matrixSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowAnyNAs(matrix, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_rowQuantilesApprox
+NumericMatrix dgCMatrix_rowQuantilesApprox(S4 matrix, NumericVector probs, bool na_rm, double compression, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowQuantilesApprox(SEXP matrixSEXP, SEXP probsSEXP, SEXP na_rmSEXP, SEXP compressionSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type probs(probsSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
+    Rcpp::traits::input_parameter< double >::type compression(compressionSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowQuantilesApprox(matrix, probs, na_rm, compression, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_rowSummary
+NumericMatrix dgCMatrix_rowSummary(S4 matrix, bool na_rm, CharacterVector stats, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowSummary(SEXP matrixSEXP, SEXP na_rmSEXP, SEXP statsSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
+    Rcpp::traits::input_parameter< CharacterVector >::type stats(statsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowSummary(matrix, na_rm, stats, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_rowStatsAccumulate
+NumericMatrix dgCMatrix_rowStatsAccumulate(S4 matrix, Nullable<NumericMatrix> state, bool na_rm);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowStatsAccumulate(SEXP matrixSEXP, SEXP stateSEXP, SEXP na_rmSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< Nullable<NumericMatrix> >::type state(stateSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowStatsAccumulate(matrix, state, na_rm));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rowStatsAccumulator_merge
+NumericMatrix rowStatsAccumulator_merge(NumericMatrix state1, NumericMatrix state2);
+RcppExport SEXP _sparseMatrixStats_rowStatsAccumulator_merge(SEXP state1SEXP, SEXP state2SEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericMatrix >::type state1(state1SEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type state2(state2SEXP);
+    rcpp_result_gen = Rcpp::wrap(rowStatsAccumulator_merge(state1, state2));
+    return rcpp_result_gen;
+END_RCPP
+}
+// rowStatsAccumulator_result
+NumericMatrix rowStatsAccumulator_result(NumericMatrix state, double n_cols, bool na_rm, CharacterVector stats);
+RcppExport SEXP _sparseMatrixStats_rowStatsAccumulator_result(SEXP stateSEXP, SEXP n_colsSEXP, SEXP na_rmSEXP, SEXP statsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericMatrix >::type state(stateSEXP);
+    Rcpp::traits::input_parameter< double >::type n_cols(n_colsSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
+    Rcpp::traits::input_parameter< CharacterVector >::type stats(statsSEXP);
+    rcpp_result_gen = Rcpp::wrap(rowStatsAccumulator_result(state, n_cols, na_rm, stats));
+    return rcpp_result_gen;
+END_RCPP
+}
+// mtx_summary
+List mtx_summary(std::string path, bool na_rm, CharacterVector stats, double chunk_size);
+RcppExport SEXP _sparseMatrixStats_mtx_summary(SEXP pathSEXP, SEXP na_rmSEXP, SEXP statsSEXP, SEXP chunk_sizeSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type path(pathSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
+    Rcpp::traits::input_parameter< CharacterVector >::type stats(statsSEXP);
+    Rcpp::traits::input_parameter< double >::type chunk_size(chunk_sizeSEXP);
+    rcpp_result_gen = Rcpp::wrap(mtx_summary(path, na_rm, stats, chunk_size));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_rowStatsByGroup
+NumericMatrix dgCMatrix_rowStatsByGroup(S4 matrix, IntegerVector group, int n_groups, CharacterVector stat, bool na_rm, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_rowStatsByGroup(SEXP matrixSEXP, SEXP groupSEXP, SEXP n_groupsSEXP, SEXP statSEXP, SEXP na_rmSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type group(groupSEXP);
+    Rcpp::traits::input_parameter< int >::type n_groups(n_groupsSEXP);
+    Rcpp::traits::input_parameter< CharacterVector >::type stat(statSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_rowStatsByGroup(matrix, group, n_groups, stat, na_rm, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dgCMatrix_colStatsByGroup
+NumericMatrix dgCMatrix_colStatsByGroup(S4 matrix, IntegerVector group, int n_groups, CharacterVector stat, bool na_rm, Nullable<IntegerVector> rows, Nullable<IntegerVector> cols);
+RcppExport SEXP _sparseMatrixStats_dgCMatrix_colStatsByGroup(SEXP matrixSEXP, SEXP groupSEXP, SEXP n_groupsSEXP, SEXP statSEXP, SEXP na_rmSEXP, SEXP rowsSEXP, SEXP colsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type group(groupSEXP);
+    Rcpp::traits::input_parameter< int >::type n_groups(n_groupsSEXP);
+    Rcpp::traits::input_parameter< CharacterVector >::type stat(statSEXP);
+    Rcpp::traits::input_parameter< bool >::type na_rm(na_rmSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< Nullable<IntegerVector> >::type cols(colsSEXP);
+    rcpp_result_gen = Rcpp::wrap(dgCMatrix_colStatsByGroup(matrix, group, n_groups, stat, na_rm, rows, cols));
+    return rcpp_result_gen;
+END_RCPP
+}
+// write_sparse_stats_file
+void write_sparse_stats_file(S4 matrix, std::string path);
+RcppExport SEXP _sparseMatrixStats_write_sparse_stats_file(SEXP matrixSEXP, SEXP pathSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< S4 >::type matrix(matrixSEXP);
+    Rcpp::traits::input_parameter< std::string >::type path(pathSEXP);
+    write_sparse_stats_file(matrix, path);
+    return R_NilValue;
+END_RCPP
+}
+// open_sparse_stats_file
+List open_sparse_stats_file(std::string path, bool check);
+RcppExport SEXP _sparseMatrixStats_open_sparse_stats_file(SEXP pathSEXP, SEXP checkSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type path(pathSEXP);
+    Rcpp::traits::input_parameter< bool >::type check(checkSEXP);
+    rcpp_result_gen = Rcpp::wrap(open_sparse_stats_file(path, check));
     return rcpp_result_gen;
 END_RCPP
 }
 
 static const R_CallMethodDef CallEntries[] = {
-    {"_sparseMatrixStats_dgCMatrix_colSums2", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colSums2, 2},
-    {"_sparseMatrixStats_dgCMatrix_colMeans2", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colMeans2, 2},
-    {"_sparseMatrixStats_dgCMatrix_colMedians", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colMedians, 2},
-    {"_sparseMatrixStats_dgCMatrix_colVars", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colVars, 3},
-    {"_sparseMatrixStats_dgCMatrix_colMads", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colMads, 4},
-    {"_sparseMatrixStats_dgCMatrix_colMins", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colMins, 2},
-    {"_sparseMatrixStats_dgCMatrix_colMaxs", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colMaxs, 2},
-    {"_sparseMatrixStats_dgCMatrix_colOrderStats", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colOrderStats, 3},
-    {"_sparseMatrixStats_dgCMatrix_colLogSumExps", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colLogSumExps, 2},
-    {"_sparseMatrixStats_dgCMatrix_colProds", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colProds, 2},
-    {"_sparseMatrixStats_dgCMatrix_colWeightedMeans", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colWeightedMeans, 3},
-    {"_sparseMatrixStats_dgCMatrix_colWeightedVars", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colWeightedVars, 3},
-    {"_sparseMatrixStats_dgCMatrix_colCounts", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colCounts, 3},
-    {"_sparseMatrixStats_dgCMatrix_colAnyNAs", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colAnyNAs, 1},
-    {"_sparseMatrixStats_dgCMatrix_colAnys", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colAnys, 3},
-    {"_sparseMatrixStats_dgCMatrix_colAlls", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colAlls, 3},
-    {"_sparseMatrixStats_dgCMatrix_colQuantiles", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colQuantiles, 3},
+    {"_sparseMatrixStats_dgCMatrix_colSums2", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colSums2, 4},
+    {"_sparseMatrixStats_dgCMatrix_colMeans2", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colMeans2, 4},
+    {"_sparseMatrixStats_dgCMatrix_colMedians", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colMedians, 4},
+    {"_sparseMatrixStats_dgCMatrix_rowMedians", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowMedians, 4},
+    {"_sparseMatrixStats_dgCMatrix_colIQRs", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colIQRs, 4},
+    {"_sparseMatrixStats_dgCMatrix_rowIQRs", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowIQRs, 4},
+    {"_sparseMatrixStats_dgCMatrix_colVars", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colVars, 5},
+    {"_sparseMatrixStats_dgCMatrix_colMads", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colMads, 6},
+    {"_sparseMatrixStats_dgCMatrix_rowMads", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowMads, 6},
+    {"_sparseMatrixStats_dgCMatrix_colMins", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colMins, 4},
+    {"_sparseMatrixStats_dgCMatrix_rowMins", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowMins, 4},
+    {"_sparseMatrixStats_dgCMatrix_colMaxs", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colMaxs, 4},
+    {"_sparseMatrixStats_dgCMatrix_rowMaxs", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowMaxs, 4},
+    {"_sparseMatrixStats_dgCMatrix_colOrderStats", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colOrderStats, 5},
+    {"_sparseMatrixStats_dgCMatrix_rowOrderStats", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowOrderStats, 5},
+    {"_sparseMatrixStats_dgCMatrix_colLogSumExps", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colLogSumExps, 4},
+    {"_sparseMatrixStats_dgCMatrix_rowLogSumExps", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowLogSumExps, 4},
+    {"_sparseMatrixStats_dgCMatrix_colProds", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colProds, 4},
+    {"_sparseMatrixStats_dgCMatrix_rowProds", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowProds, 4},
+    {"_sparseMatrixStats_dgCMatrix_colSummary", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colSummary, 5},
+    {"_sparseMatrixStats_dgCMatrix_colWeightedMeans", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colWeightedMeans, 5},
+    {"_sparseMatrixStats_dgCMatrix_rowWeightedMeans", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowWeightedMeans, 5},
+    {"_sparseMatrixStats_dgCMatrix_colWeightedVars", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colWeightedVars, 5},
+    {"_sparseMatrixStats_dgCMatrix_rowWeightedVars", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowWeightedVars, 5},
+    {"_sparseMatrixStats_dgCMatrix_colWeightedMedians", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colWeightedMedians, 5},
+    {"_sparseMatrixStats_dgCMatrix_rowWeightedMedians", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowWeightedMedians, 5},
+    {"_sparseMatrixStats_dgCMatrix_colWeightedMads", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colWeightedMads, 6},
+    {"_sparseMatrixStats_dgCMatrix_rowWeightedMads", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowWeightedMads, 6},
+    {"_sparseMatrixStats_dgCMatrix_colCounts", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colCounts, 5},
+    {"_sparseMatrixStats_dgCMatrix_colAnyNAs", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colAnyNAs, 3},
+    {"_sparseMatrixStats_dgCMatrix_colAnys", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colAnys, 5},
+    {"_sparseMatrixStats_dgCMatrix_rowAnys", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowAnys, 5},
+    {"_sparseMatrixStats_dgCMatrix_colAlls", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colAlls, 5},
+    {"_sparseMatrixStats_dgCMatrix_rowAlls", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowAlls, 5},
+    {"_sparseMatrixStats_dgCMatrix_colQuantiles", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colQuantiles, 5},
+    {"_sparseMatrixStats_dgCMatrix_rowQuantiles", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowQuantiles, 5},
+    {"_sparseMatrixStats_dgCMatrix_colQuantilesApprox", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colQuantilesApprox, 6},
+    {"_sparseMatrixStats_dgCMatrix_colTopK", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colTopK, 5},
+    {"_sparseMatrixStats_dgCMatrix_rowTopK", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowTopK, 5},
     {"_sparseMatrixStats_dgCMatrix_colTabulate", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colTabulate, 2},
-    {"_sparseMatrixStats_dgCMatrix_colCumsums", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colCumsums, 1},
-    {"_sparseMatrixStats_dgCMatrix_colCumprods", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colCumprods, 1},
-    {"_sparseMatrixStats_dgCMatrix_colCummins", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colCummins, 1},
-    {"_sparseMatrixStats_dgCMatrix_colCummaxs", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colCummaxs, 1},
-    {"_sparseMatrixStats_dgCMatrix_colRanks_num", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colRanks_num, 4},
-    {"_sparseMatrixStats_dgCMatrix_colRanks_int", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colRanks_int, 4},
+    {"_sparseMatrixStats_dgCMatrix_colCumsums", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colCumsums, 3},
+    {"_sparseMatrixStats_dgCMatrix_rowCumsums", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowCumsums, 3},
+    {"_sparseMatrixStats_dgCMatrix_colCumprods", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colCumprods, 3},
+    {"_sparseMatrixStats_dgCMatrix_rowCumprods", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowCumprods, 3},
+    {"_sparseMatrixStats_dgCMatrix_colCummins", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colCummins, 3},
+    {"_sparseMatrixStats_dgCMatrix_rowCummins", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowCummins, 3},
+    {"_sparseMatrixStats_dgCMatrix_colCummaxs", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colCummaxs, 3},
+    {"_sparseMatrixStats_dgCMatrix_rowCummaxs", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowCummaxs, 3},
+    {"_sparseMatrixStats_dgCMatrix_colCumulative_sparse", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colCumulative_sparse, 4},
+    {"_sparseMatrixStats_dgCMatrix_rowCumulative_sparse", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowCumulative_sparse, 4},
+    {"_sparseMatrixStats_dgCMatrix_colDiffs", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colDiffs, 5},
+    {"_sparseMatrixStats_dgCMatrix_rowDiffs", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowDiffs, 5},
+    {"_sparseMatrixStats_dgCMatrix_colDiffs_sparse", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colDiffs_sparse, 5},
+    {"_sparseMatrixStats_dgCMatrix_rowDiffs_sparse", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowDiffs_sparse, 5},
+    {"_sparseMatrixStats_dgCMatrix_colDiffStats", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colDiffStats, 7},
+    {"_sparseMatrixStats_dgCMatrix_rowDiffStats", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowDiffStats, 7},
+    {"_sparseMatrixStats_dgCMatrix_colRanks_num", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colRanks_num, 6},
+    {"_sparseMatrixStats_dgCMatrix_rowRanks_num", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowRanks_num, 6},
+    {"_sparseMatrixStats_dgCMatrix_colRanks_int", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colRanks_int, 6},
+    {"_sparseMatrixStats_dgCMatrix_rowRanks_int", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowRanks_int, 6},
+    {"_sparseMatrixStats_dgCMatrix_colRanks_sparse", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colRanks_sparse, 6},
+    {"_sparseMatrixStats_dgCMatrix_rowRanks_sparse", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowRanks_sparse, 6},
     {"_sparseMatrixStats_quantile_sparse", (DL_FUNC) &_sparseMatrixStats_quantile_sparse, 3},
-    {"_sparseMatrixStats_dgCMatrix_rowSums2", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowSums2, 2},
-    {"_sparseMatrixStats_dgCMatrix_rowMeans2", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowMeans2, 2},
-    {"_sparseMatrixStats_dgCMatrix_rowVars", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowVars, 3},
+    {"_sparseMatrixStats_dgCMatrix_rowSums2", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowSums2, 4},
+    {"_sparseMatrixStats_dgCMatrix_rowMeans2", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowMeans2, 4},
+    {"_sparseMatrixStats_dgCMatrix_rowVars", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowVars, 5},
+    {"_sparseMatrixStats_dgCMatrix_rowCounts", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowCounts, 5},
+    {"_sparseMatrixStats_dgCMatrix_rowAnyNAs", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowAnyNAs, 3},
+    {"_sparseMatrixStats_dgCMatrix_rowQuantilesApprox", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowQuantilesApprox, 6},
+    {"_sparseMatrixStats_dgCMatrix_rowSummary", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowSummary, 5},
+    {"_sparseMatrixStats_dgCMatrix_rowStatsAccumulate", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowStatsAccumulate, 3},
+    {"_sparseMatrixStats_rowStatsAccumulator_merge", (DL_FUNC) &_sparseMatrixStats_rowStatsAccumulator_merge, 2},
+    {"_sparseMatrixStats_rowStatsAccumulator_result", (DL_FUNC) &_sparseMatrixStats_rowStatsAccumulator_result, 4},
+    {"_sparseMatrixStats_mtx_summary", (DL_FUNC) &_sparseMatrixStats_mtx_summary, 4},
+    {"_sparseMatrixStats_dgCMatrix_rowStatsByGroup", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_rowStatsByGroup, 7},
+    {"_sparseMatrixStats_dgCMatrix_colStatsByGroup", (DL_FUNC) &_sparseMatrixStats_dgCMatrix_colStatsByGroup, 7},
+    {"_sparseMatrixStats_write_sparse_stats_file", (DL_FUNC) &_sparseMatrixStats_write_sparse_stats_file, 2},
+    {"_sparseMatrixStats_open_sparse_stats_file", (DL_FUNC) &_sparseMatrixStats_open_sparse_stats_file, 2},
     {NULL, NULL, 0}
 };
 
@@ -1,22 +1,201 @@
 #include <Rcpp.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include "SparseMatrixView.h"
-#include "VectorSubsetView.h"
+#include "parallel.h"
+#include "sparse_stats_file.h"
 using namespace Rcpp;
 
 // [[Rcpp::plugins("cpp11")]]
 
-dgCMatrixView wrap_dgCMatrix(Rcpp::S4 sp_mat){
+template<int RTYPE>
+SparseMatrixView<RTYPE> wrap_sparse_matrix(Rcpp::S4 sp_mat){
   Rcpp::IntegerVector dim = sp_mat.slot("Dim");
-  Rcpp::NumericVector values = sp_mat.slot("x");
+  Rcpp::Vector<RTYPE> values = sp_mat.slot("x");
   R_len_t nrows = dim[0];
   R_len_t ncols = dim[1];
 
   Rcpp::IntegerVector row_indices = sp_mat.slot("i");
-  Rcpp::IntegerVector col_ptrs = sp_mat.slot("p");
-  return dgCMatrixView(nrows, ncols, values, row_indices, col_ptrs);
+  SEXP col_ptrs = sp_mat.slot("p");
+  if(TYPEOF(col_ptrs) != INTSXP && TYPEOF(col_ptrs) != REALSXP){
+    throw std::runtime_error("The column pointers (slot p) must be an integer or double vector");
+  }
+  return SparseMatrixView<RTYPE>(nrows, ncols, values, row_indices, col_ptrs);
+}
+
+// The full matrix. A SparseStatsFile only stores doubles, so it is only
+// handled for RTYPE == REALSXP. sequential is the access pattern hint for a
+// mapped file.
+template<int RTYPE>
+struct FullMatrix {
+  static SparseMatrixView<RTYPE> wrap(Rcpp::S4 sp_mat, bool /*sequential*/){
+    return wrap_sparse_matrix<RTYPE>(sp_mat);
+  }
+};
+
+template<>
+struct FullMatrix<REALSXP> {
+  static dgCMatrixView wrap(Rcpp::S4 sp_mat, bool sequential){
+    if(is_sparse_stats_file(sp_mat)){
+      return wrap_sparse_stats_file(sp_mat, sequential);
+    }
+    return wrap_sparse_matrix<REALSXP>(sp_mat);
+  }
+};
+
+dgCMatrixView wrap_dgCMatrix(Rcpp::S4 sp_mat){
+  return FullMatrix<REALSXP>::wrap(sp_mat, true);
+}
+
+
+template<int RTYPE>
+SparseMatrixView<RTYPE> wrap_sparse_matrix(Rcpp::S4 sp_mat, Rcpp::Nullable<Rcpp::IntegerVector> rows, Rcpp::Nullable<Rcpp::IntegerVector> cols){
+  // A column subset jumps around in the file, the rows are still read in
+  // order within each column
+  SparseMatrixView<RTYPE> full = FullMatrix<RTYPE>::wrap(sp_mat, cols.isNull());
+  if(rows.isNull() && cols.isNull()){
+    return full;
+  }
+  R_len_t nrows = full.nrow;
+  R_len_t ncols = full.ncol;
+  Rcpp::IntegerVector col_subset(0);
+  Rcpp::IntegerVector row_map(0);
+  Rcpp::IntegerVector row_subset(0);
+  if(cols.isNotNull()){
+    Rcpp::IntegerVector cols_vec(cols.get());
+    col_subset = Rcpp::IntegerVector(cols_vec.size());
+    for(R_len_t k = 0; k < cols_vec.size(); ++k){
+      if(cols_vec[k] == NA_INTEGER || cols_vec[k] < 1 || cols_vec[k] > ncols){
+        throw std::range_error("cols are out of bounds");
+      }
+      col_subset[k] = cols_vec[k] - 1;
+    }
+    ncols = cols_vec.size();
+  }
+  if(rows.isNotNull()){
+    Rcpp::IntegerVector rows_vec(rows.get());
+    row_map = Rcpp::IntegerVector(full.nrow, -1);
+    row_subset = Rcpp::IntegerVector(rows_vec.size());
+    int previous = 0;
+    for(R_len_t k = 0; k < rows_vec.size(); ++k){
+      if(rows_vec[k] == NA_INTEGER || rows_vec[k] < 1 || rows_vec[k] > full.nrow){
+        throw std::range_error("rows are out of bounds");
+      }
+      if(rows_vec[k] <= previous){
+        throw std::range_error("rows must be strictly increasing");
+      }
+      previous = rows_vec[k];
+      row_map[rows_vec[k] - 1] = k;
+      row_subset[k] = rows_vec[k] - 1;
+    }
+    nrows = rows_vec.size();
+  }
+  return full.with_subset(nrows, ncols, col_subset, row_map, row_subset);
+}
+
+dgCMatrixView wrap_dgCMatrix(Rcpp::S4 sp_mat, Rcpp::Nullable<Rcpp::IntegerVector> rows, Rcpp::Nullable<Rcpp::IntegerVector> cols){
+  return wrap_sparse_matrix<REALSXP>(sp_mat, rows, cols);
+}
+
+lgCMatrixView wrap_lgCMatrix(Rcpp::S4 sp_mat, Rcpp::Nullable<Rcpp::IntegerVector> rows, Rcpp::Nullable<Rcpp::IntegerVector> cols){
+  return wrap_sparse_matrix<LGLSXP>(sp_mat, rows, cols);
+}
+
+
+SEXP make_col_ptrs(const std::vector<R_xlen_t>& positions){
+  R_xlen_t size = positions.size();
+  if(size == 0 || positions[size - 1] <= std::numeric_limits<int>::max()){
+    return Rcpp::IntegerVector(positions.begin(), positions.end());
+  }
+  return Rcpp::NumericVector(positions.begin(), positions.end());
+}
+
+
+dgCMatrixView transpose_dgCMatrixView(const dgCMatrixView& sp_mat){
+  std::vector<R_xlen_t> cursors;
+  return transpose_dgCMatrixView(sp_mat, 0, sp_mat.nrow, cursors);
+}
+
+
+dgCMatrixView transpose_dgCMatrixView(const dgCMatrixView& sp_mat, R_len_t row_begin, R_len_t row_end, std::vector<R_xlen_t>& cursors){
+  // The rows of the tile are the row indices [source_row_begin, source_row_end)
+  // in the slots, which are mapped to the rows of the view if it has a row filter
+  int source_row_begin = sp_mat.source_row(row_begin);
+  int source_row_end = sp_mat.source_row(row_end);
+  const int* idx_ptr = sp_mat.row_indices_ptr;
+  if(cursors.empty()){
+    cursors.resize(sp_mat.ncol);
+    for(R_len_t col = 0; col < sp_mat.ncol; ++col){
+      cursors[col] = std::lower_bound(idx_ptr + sp_mat.col_begin(col), idx_ptr + sp_mat.col_end(col), source_row_begin) - idx_ptr;
+    }
+  }
+  R_len_t n_rows = row_end - row_begin;
+  std::vector<R_xlen_t> col_ptrs(n_rows + 1, 0);
+  for(R_len_t col = 0; col < sp_mat.ncol; ++col){
+    for(R_xlen_t i = cursors[col], end = sp_mat.col_end(col); i < end && idx_ptr[i] < source_row_end; ++i){
+      int row = sp_mat.view_row(idx_ptr[i]);
+      if(row >= 0){
+        ++col_ptrs[row - row_begin + 1];
+      }
+    }
+  }
+  for(R_len_t row = 0; row < n_rows; ++row){
+    col_ptrs[row + 1] += col_ptrs[row];
+  }
+  R_xlen_t nnz = col_ptrs[n_rows];
+  Rcpp::NumericVector values = Rcpp::no_init(nnz);
+  Rcpp::IntegerVector row_indices = Rcpp::no_init(nnz);
+  std::vector<R_xlen_t> next_pos(col_ptrs.begin(), col_ptrs.end() - 1);
+  double* values_ptr = values.begin();
+  int* row_indices_ptr = row_indices.begin();
+  for(R_len_t col = 0; col < sp_mat.ncol; ++col){
+    R_xlen_t i = cursors[col];
+    for(R_xlen_t end = sp_mat.col_end(col); i < end && idx_ptr[i] < source_row_end; ++i){
+      int row = sp_mat.view_row(idx_ptr[i]);
+      if(row >= 0){
+        R_xlen_t pos = next_pos[row - row_begin]++;
+        values_ptr[pos] = sp_mat.values_ptr[i];
+        row_indices_ptr[pos] = col;
+      }
+    }
+    cursors[col] = i;
+  }
+  return dgCMatrixView(sp_mat.ncol, n_rows, values, row_indices, make_col_ptrs(col_ptrs));
+}
+
+
+R_len_t transpose_tile_rows(const dgCMatrixView& sp_mat){
+  R_xlen_t nnz = sp_mat.stored_size();
+  if(! sp_mat.is_mapped() || nnz == 0){
+    return sp_mat.nrow;
+  }
+  // A transposed element takes a double and an int
+  double max_elements = (double) get_transpose_block_size() / (sizeof(double) + sizeof(int));
+  double tile_rows = std::floor(max_elements * sp_mat.nrow / nnz);
+  return (R_len_t) std::max(std::min(tile_rows, (double) sp_mat.nrow), 1.0);
 }
 
 
+
+Rcpp::S4 as_dgCMatrix(const dgCMatrixView& sp_mat){
+  if(sp_mat.col_subset_ptr != nullptr || sp_mat.has_row_filter()){
+    throw std::runtime_error("as_dgCMatrix() cannot handle a view on a subset");
+  }
+  if(sp_mat.is_mapped()){
+    throw std::runtime_error("as_dgCMatrix() cannot handle a view on a SparseStatsFile");
+  }
+  if(sp_mat.has_long_col_ptrs()){
+    throw std::range_error("The result has too many non-zero elements for a dgCMatrix");
+  }
+  Rcpp::S4 result("dgCMatrix");
+  result.slot("Dim") = Rcpp::IntegerVector::create(sp_mat.nrow, sp_mat.ncol);
+  result.slot("i") = sp_mat.row_indices;
+  result.slot("p") = sp_mat.col_ptrs;
+  result.slot("x") = sp_mat.values;
+  return result;
+}
+
 // // [[Rcpp::export]]
 // void print_matrix(Rcpp::S4 matrix){
 //   auto sp_mat = wrap_dgCMatrix(matrix);
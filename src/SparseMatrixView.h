@@ -2,22 +2,218 @@
 #define SparseMatrixView_h
 
 #include <Rcpp.h>
+#include <vector>
 using namespace Rcpp;
 
-class dgCMatrixView {
+// A column-compressed sparse matrix (the slots of a dgCMatrix or an
+// lgCMatrix). RTYPE is the type of the x slot, so that a logical matrix is
+// used without coercing the values to double.
+// The column pointers can be an integer vector (as in the Matrix package) or
+// a double vector, which allows more than 2^31 - 1 stored elements (a long x
+// slot). The positions in the slots are always R_xlen_t, the row indices and
+// the number of elements per column stay int.
+template<int RTYPE>
+class SparseMatrixView {
 
 public:
+  typedef typename Rcpp::traits::storage_type<RTYPE>::type value_type;
+
   const R_len_t nrow;
   const R_len_t ncol;
-  const NumericVector values;
+  const Rcpp::Vector<RTYPE> values;
   const IntegerVector row_indices;
-  const IntegerVector col_ptrs;
+  const RObject col_ptrs;
+  // Keeps data outside of the R heap alive (the mapping of a
+  // SparseStatsFile), NULL if the view is on the slots above.
+  const RObject storage;
+
+  // Optional subset of the matrix in the slots above (see wrap_dgCMatrix()).
+  // Column col of the view is column col_subset[col] of the slots, and an
+  // element with row index i in the slots is in row row_map[i] of the view,
+  // or not part of the view if row_map[i] < 0. row_subset is the inverse of
+  // row_map (the sorted rows of the slots that are selected). The vectors are
+  // empty if the view covers all columns / rows.
+  const IntegerVector col_subset;
+  const IntegerVector row_map;
+  const IntegerVector row_subset;
+
+  // Raw pointers into the slots (or the storage) above. The Rcpp vectors
+  // keep the data alive, the pointers can be used from worker threads.
+  // The subset pointers are nullptr if there is no subset.
+  const value_type* const values_ptr;
+  const int* const row_indices_ptr;
+  // Exactly one of the two is set, depending on the type of col_ptrs
+  const int* const col_ptrs_ptr;
+  const double* const long_col_ptrs_ptr;
+  const int* const col_subset_ptr;
+  const int* const row_map_ptr;
+  const int* const row_subset_ptr;
+
+  SparseMatrixView(R_len_t nrow_, R_len_t ncol_, const Rcpp::Vector<RTYPE> values_, const IntegerVector row_indices_, SEXP col_ptrs_):
+    SparseMatrixView(nrow_, ncol_, values_, row_indices_, col_ptrs_, IntegerVector(0), IntegerVector(0), IntegerVector(0)) {}
+
+  SparseMatrixView(R_len_t nrow_, R_len_t ncol_, const Rcpp::Vector<RTYPE> values_, const IntegerVector row_indices_, SEXP col_ptrs_,
+                const IntegerVector col_subset_, const IntegerVector row_map_, const IntegerVector row_subset_):
+    SparseMatrixView(nrow_, ncol_, values_, row_indices_, col_ptrs_, R_NilValue,
+                     values_.begin(), row_indices_.begin(),
+                     TYPEOF(col_ptrs_) == INTSXP ? INTEGER(col_ptrs_) : nullptr,
+                     TYPEOF(col_ptrs_) == REALSXP ? REAL(col_ptrs_) : nullptr,
+                     col_subset_, row_map_, row_subset_) {}
+
+  // A view on arrays outside of the R heap (see sparse_stats_file.h). The
+  // Rcpp vectors are empty, storage keeps the arrays alive.
+  SparseMatrixView(R_len_t nrow_, R_len_t ncol_, const value_type* values_ptr_, const int* row_indices_ptr_,
+                const double* long_col_ptrs_ptr_, SEXP storage_):
+    SparseMatrixView(nrow_, ncol_, Rcpp::Vector<RTYPE>(0), IntegerVector(0), R_NilValue, storage_,
+                     values_ptr_, row_indices_ptr_, nullptr, long_col_ptrs_ptr_,
+                     IntegerVector(0), IntegerVector(0), IntegerVector(0)) {}
+
+  // The same data with a different subset (see wrap_dgCMatrix())
+  SparseMatrixView with_subset(R_len_t nrow_, R_len_t ncol_, const IntegerVector col_subset_,
+                               const IntegerVector row_map_, const IntegerVector row_subset_) const {
+    return SparseMatrixView(nrow_, ncol_, values, row_indices, col_ptrs, storage,
+                            values_ptr, row_indices_ptr, col_ptrs_ptr, long_col_ptrs_ptr,
+                            col_subset_, row_map_, row_subset_);
+  }
+
+  bool is_mapped() const {
+    return ! Rf_isNull(storage);
+  }
+
+  bool has_row_filter() const {
+    return row_map_ptr != nullptr;
+  }
+
+  bool has_long_col_ptrs() const {
+    return long_col_ptrs_ptr != nullptr;
+  }
+
+  // The k-th entry of the column pointers (k is a column of the slots). The
+  // branch is taken once per column, the loops over the elements of a column
+  // are the same for both types.
+  R_xlen_t col_ptr(R_len_t k) const {
+    return col_ptrs_ptr != nullptr ? (R_xlen_t) col_ptrs_ptr[k] : (R_xlen_t) long_col_ptrs_ptr[k];
+  }
+
+  // Position of the first / one past the last element of a column in the slots
+  R_xlen_t col_begin(R_len_t col) const {
+    return col_ptr(col_subset_ptr == nullptr ? col : col_subset_ptr[col]);
+  }
+
+  R_xlen_t col_end(R_len_t col) const {
+    return col_ptr((col_subset_ptr == nullptr ? col : col_subset_ptr[col]) + 1);
+  }
 
-  dgCMatrixView(R_len_t nrow_, R_len_t ncol_, const NumericVector values_, const IntegerVector row_indices_, const IntegerVector col_ptrs_):
-    nrow(nrow_), ncol(ncol_), values(values_), row_indices(row_indices_), col_ptrs(col_ptrs_) {}
+  // The row of the view for a row index from the slots, -1 if it is not selected
+  int view_row(int source_row) const {
+    return row_map_ptr == nullptr ? source_row : row_map_ptr[source_row];
+  }
+
+  // The row index in the slots for a row of the view. row == nrow gives the
+  // number of rows in the slots, so that [source_row(a), source_row(b)) covers
+  // the rows [a, b) of the view.
+  int source_row(R_len_t row) const {
+    if(row_map_ptr == nullptr){
+      return row;
+    }
+    return row < nrow ? row_subset_ptr[row] : (int) row_map.size();
+  }
+
+  // Number of stored elements in the selected columns (including the ones in
+  // rows that are filtered out)
+  R_xlen_t stored_size() const {
+    if(col_subset_ptr == nullptr){
+      return col_ptr(ncol);
+    }
+    R_xlen_t size = 0;
+    for(R_len_t col = 0; col < ncol; ++col){
+      size += col_end(col) - col_begin(col);
+    }
+    return size;
+  }
+
+private:
+  SparseMatrixView(R_len_t nrow_, R_len_t ncol_, const Rcpp::Vector<RTYPE> values_, const IntegerVector row_indices_,
+                SEXP col_ptrs_, SEXP storage_, const value_type* values_ptr_, const int* row_indices_ptr_,
+                const int* col_ptrs_ptr_, const double* long_col_ptrs_ptr_,
+                const IntegerVector col_subset_, const IntegerVector row_map_, const IntegerVector row_subset_):
+    nrow(nrow_), ncol(ncol_), values(values_), row_indices(row_indices_), col_ptrs(col_ptrs_), storage(storage_),
+    col_subset(col_subset_), row_map(row_map_), row_subset(row_subset_),
+    values_ptr(values_ptr_), row_indices_ptr(row_indices_ptr_),
+    col_ptrs_ptr(col_ptrs_ptr_), long_col_ptrs_ptr(long_col_ptrs_ptr_),
+    col_subset_ptr(col_subset.size() == 0 ? nullptr : col_subset.begin()),
+    row_map_ptr(row_map.size() == 0 ? nullptr : row_map.begin()),
+    row_subset_ptr(row_map.size() == 0 ? nullptr : row_subset.begin()) {}
 
 };
 
+typedef SparseMatrixView<REALSXP> dgCMatrixView;
+typedef SparseMatrixView<LGLSXP> lgCMatrixView;
+
+// A view on a dgCMatrix, or on the mapping of a SparseStatsFile (see
+// sparse_stats_file.h)
 dgCMatrixView wrap_dgCMatrix(Rcpp::S4 sp_mat);
 
+// A view on the subset x[rows, cols] of sp_mat, without copying the data. rows
+// and cols are 1-based indices (NULL selects everything). cols can be in any
+// order and contain duplicates, rows have to be strictly increasing. The
+// columns are mapped to ranges of the slots, the rows are filtered out when
+// the columns are accessed (see ColumnView).
+dgCMatrixView wrap_dgCMatrix(Rcpp::S4 sp_mat, Rcpp::Nullable<Rcpp::IntegerVector> rows, Rcpp::Nullable<Rcpp::IntegerVector> cols);
+
+// The same for an lgCMatrix, the logical x slot is used as is
+lgCMatrixView wrap_lgCMatrix(Rcpp::S4 sp_mat, Rcpp::Nullable<Rcpp::IntegerVector> rows, Rcpp::Nullable<Rcpp::IntegerVector> cols);
+
+// Whether sp_mat is a SparseStatsFile (a matrix in a memory-mapped file)
+// instead of a dgCMatrix / lgCMatrix
+bool is_sparse_stats_file(Rcpp::S4 sp_mat);
+
+// Column pointers for the given positions: an integer vector if all of them
+// fit into an int, a double vector otherwise. Must be called from the main
+// thread.
+SEXP make_col_ptrs(const std::vector<R_xlen_t>& positions);
+
+// Calls op with the view of sp_mat[rows, cols]: an lgCMatrixView if the x
+// slot is logical, a dgCMatrixView otherwise (also for a SparseStatsFile). For the kernels that work on
+// both types of storage.
+template<typename Functor>
+auto dispatch_sparse_view(Rcpp::S4 sp_mat, Rcpp::Nullable<Rcpp::IntegerVector> rows, Rcpp::Nullable<Rcpp::IntegerVector> cols, Functor op) -> decltype(op(wrap_dgCMatrix(sp_mat))) {
+  if(is_sparse_stats_file(sp_mat)){
+    return op(wrap_dgCMatrix(sp_mat, rows, cols));
+  }
+  SEXP values = sp_mat.slot("x");
+  if(TYPEOF(values) == LGLSXP){
+    return op(wrap_lgCMatrix(sp_mat, rows, cols));
+  }
+  return op(wrap_dgCMatrix(sp_mat, rows, cols));
+}
+
+// The transposed matrix (its columns are the rows of sp_mat), built with a
+// counting sort over the row indices in O(nnz + nrow). Within each new column
+// the entries are ordered by their original column, so the row indices stay
+// sorted. For a subset view, only the selected elements are copied.
+// Allocates R vectors, must be called from the main thread.
+dgCMatrixView transpose_dgCMatrixView(const dgCMatrixView& sp_mat);
+
+// The transpose of the rows [row_begin, row_end) of sp_mat (a row tile), so
+// that the column kernels can run on the rows of a matrix that is too large
+// to be transposed at once. cursors holds the position of the next element of
+// each column, it is initialized if empty and moved past the tile, so
+// consecutive tiles find their elements without searching the columns again.
+// Allocates R vectors, must be called from the main thread.
+dgCMatrixView transpose_dgCMatrixView(const dgCMatrixView& sp_mat, R_len_t row_begin, R_len_t row_end, std::vector<R_xlen_t>& cursors);
+
+// The number of rows of the tiles in which the row functions transpose
+// sp_mat: all rows for a matrix in memory, for a view on a SparseStatsFile
+// as many as fit into options(sparseMatrixStats.transpose_block_size) bytes
+// on average (see get_transpose_block_size()). Must be called from the main
+// thread.
+R_len_t transpose_tile_rows(const dgCMatrixView& sp_mat);
+
+// Wraps the slots of a view without subsets in a new dgCMatrix (the slots are
+// shared, not copied). Throws a std::range_error if the view has more
+// elements than a dgCMatrix can store (double column pointers). Allocates R
+// objects, must be called from the main thread.
+Rcpp::S4 as_dgCMatrix(const dgCMatrixView& sp_mat);
+
 #endif /* SparseMatrixView_h */
@@ -1,198 +1,364 @@
 #include <Rcpp.h>
 #include "SparseMatrixView.h"
 #include "ColumnView.h"
-#include "VectorSubsetView.h"
-#include "SkipNAVectorSubsetView.h"
+#include "ColumnSpan.h"
 #include "quantile.h"
+#include "quantile_sketch.h"
+#include "top_k.h"
 #include "sample_rank.h"
 #include "my_utils.h"
+#include "parallel.h"
+#include "summary_stats.h"
 
 using namespace Rcpp;
 
 
 
+// The reducers below hand each column to op and collect the results. The
+// columns are processed in parallel if n_threads > 1 (see parallel.h), so op
+// must not use the R API. Kernels that do, have to pass n_threads = 1.
+// The columns that op gets carry their NA policy in the type (see NaPolicy.h):
+// with na_rm = TRUE the NA's are already removed, if the matrix does not
+// contain any NA's, op is instantiated without NA handling.
+// Each reducer also accepts a dgCMatrixView, so that the same kernel can run
+// on the rows of a matrix via reduce_row_tiles() (see the
+// dgCMatrix_rowXXX functions). The vector reducers also take an
+// lgCMatrixView, then op gets the logical values as ints (see
+// dispatch_sparse_view()).
+
+template<int RTYPE, typename Functor>
+NumericVector reduce_matrix_double(const SparseMatrixView<RTYPE>& sp_mat, bool na_rm, Functor op, int n_threads = get_n_threads()){
+  SparseColumnView<RTYPE> cv(&sp_mat);
+  NumericVector result(sp_mat.ncol);
+  double* result_ptr = result.begin();
+  dispatch_na_policy(sp_mat, na_rm, [&](auto na_policy) -> void {
+    parallel_for_columns(sp_mat, n_threads, [&cv, &op, result_ptr, na_policy](R_len_t col_idx) -> void {
+      auto col = cv.column(col_idx, na_policy);
+      result_ptr[col_idx] = op(col.values, col.row_indices, col.number_of_zeros);
+    });
+  });
+  return result;
+}
+
 template<typename Functor>
-NumericVector reduce_matrix_double(S4 matrix, bool na_rm, Functor op){
-  dgCMatrixView sp_mat = wrap_dgCMatrix(matrix);
-  ColumnView cv(&sp_mat);
-  std::vector<double> result;
-  result.reserve(sp_mat.ncol);
-  if(na_rm){
-    std::transform(cv.begin(), cv.end(), std::back_inserter(result),
-      [op](ColumnView::col_container col) -> double {
-        SkipNAVectorSubsetView<REALSXP> values_wrapper(&col.values);
-        SkipNAVectorSubsetView<INTSXP> row_indices_wrapper(&col.row_indices);
-        return op(values_wrapper, row_indices_wrapper, col.number_of_zeros);
-      });
-  }else{
-    std::transform(cv.begin(), cv.end(), std::back_inserter(result),
-      [op](ColumnView::col_container col) -> double {
-        return op(col.values, col.row_indices, col.number_of_zeros);
-      });
-  }
-  return wrap(result);
+NumericVector reduce_matrix_double(S4 matrix, bool na_rm, Functor op, int n_threads = get_n_threads()){
+  return reduce_matrix_double(wrap_dgCMatrix(matrix), na_rm, op, n_threads);
+}
+
+template<int RTYPE, typename Functor>
+IntegerVector reduce_matrix_int(const SparseMatrixView<RTYPE>& sp_mat, bool na_rm, Functor op, int n_threads = get_n_threads()){
+  SparseColumnView<RTYPE> cv(&sp_mat);
+  IntegerVector result(sp_mat.ncol);
+  int* result_ptr = result.begin();
+  dispatch_na_policy(sp_mat, na_rm, [&](auto na_policy) -> void {
+    parallel_for_columns(sp_mat, n_threads, [&cv, &op, result_ptr, na_policy](R_len_t col_idx) -> void {
+      auto col = cv.column(col_idx, na_policy);
+      result_ptr[col_idx] = op(col.values, col.row_indices, col.number_of_zeros);
+    });
+  });
+  return result;
 }
 
 template<typename Functor>
-IntegerVector reduce_matrix_int(S4 matrix, bool na_rm, Functor op){
-  dgCMatrixView sp_mat = wrap_dgCMatrix(matrix);
-  ColumnView cv(&sp_mat);
-  std::vector<int> result;
-  result.reserve(sp_mat.ncol);
-  if(na_rm){
-    std::transform(cv.begin(), cv.end(), std::back_inserter(result),
-                   [op](ColumnView::col_container col) -> int {
-                     SkipNAVectorSubsetView<REALSXP> values_wrapper(&col.values);
-                     SkipNAVectorSubsetView<INTSXP> row_indices_wrapper(&col.row_indices);
-                     return op(values_wrapper, row_indices_wrapper, col.number_of_zeros);
-                   });
-  }else{
-    std::transform(cv.begin(), cv.end(), std::back_inserter(result),
-                   [op](ColumnView::col_container col) -> int {
-                     return op(col.values, col.row_indices, col.number_of_zeros);
-                   });
-  }
-  return wrap(result);
+IntegerVector reduce_matrix_int(S4 matrix, bool na_rm, Functor op, int n_threads = get_n_threads()){
+  return reduce_matrix_int(wrap_dgCMatrix(matrix), na_rm, op, n_threads);
+}
+
+template<int RTYPE, typename Functor>
+LogicalVector reduce_matrix_lgl(const SparseMatrixView<RTYPE>& sp_mat, bool na_rm, Functor op, int n_threads = get_n_threads()){
+  SparseColumnView<RTYPE> cv(&sp_mat);
+  LogicalVector result(sp_mat.ncol);
+  int* result_ptr = result.begin();
+  dispatch_na_policy(sp_mat, na_rm, [&](auto na_policy) -> void {
+    parallel_for_columns(sp_mat, n_threads, [&cv, &op, result_ptr, na_policy](R_len_t col_idx) -> void {
+      auto col = cv.column(col_idx, na_policy);
+      result_ptr[col_idx] = op(col.values, col.row_indices, col.number_of_zeros);
+    });
+  });
+  return result;
 }
 
 template<typename Functor>
-LogicalVector reduce_matrix_lgl(S4 matrix, bool na_rm, Functor op){
-  dgCMatrixView sp_mat = wrap_dgCMatrix(matrix);
-  ColumnView cv(&sp_mat);
-  std::vector<int> result;
-  result.reserve(sp_mat.ncol);
-  if(na_rm){
-    std::transform(cv.begin(), cv.end(), std::back_inserter(result),
-                   [op](ColumnView::col_container col) -> int {
-                     SkipNAVectorSubsetView<REALSXP> values_wrapper(&col.values);
-                     SkipNAVectorSubsetView<INTSXP> row_indices_wrapper(&col.row_indices);
-                     return op(values_wrapper, row_indices_wrapper, col.number_of_zeros);
-                   });
-  }else{
-    std::transform(cv.begin(), cv.end(), std::back_inserter(result),
-                   [op](ColumnView::col_container col) -> int {
-                     return op(col.values, col.row_indices, col.number_of_zeros);
-                   });
-  }
-  return wrap(result);
+LogicalVector reduce_matrix_lgl(S4 matrix, bool na_rm, Functor op, int n_threads = get_n_threads()){
+  return reduce_matrix_lgl(wrap_dgCMatrix(matrix), na_rm, op, n_threads);
 }
 
 
 template<typename Functor>
-NumericVector reduce_matrix_double_with_index(S4 matrix, bool na_rm, Functor op){
-  dgCMatrixView sp_mat = wrap_dgCMatrix(matrix);
+NumericVector reduce_matrix_double_with_index(const dgCMatrixView& sp_mat, bool na_rm, Functor op, int n_threads = get_n_threads()){
   ColumnView cv(&sp_mat);
-  int ncol =  sp_mat.ncol;
-  NumericVector result(ncol);
-  if(na_rm){
-    ColumnView::iterator col_iter = cv.begin();
-    for(int col_idx = 0; col_idx < ncol; col_idx++){
-      ColumnView::col_container col = *col_iter;
-      SkipNAVectorSubsetView<REALSXP> values_wrapper(&col.values);
-      SkipNAVectorSubsetView<INTSXP> row_indices_wrapper(&col.row_indices);
-      result[col_idx] = op(values_wrapper, row_indices_wrapper, col.number_of_zeros, col_idx);
-      ++col_iter;
-    }
-  }else{
-    ColumnView::iterator col_iter = cv.begin();
-    for(int col_idx = 0; col_idx < ncol; col_idx++){
-      ColumnView::col_container col = *col_iter;
-      result[col_idx] = op(col.values, col.row_indices, col.number_of_zeros, col_idx);
-      ++col_iter;
-    }
-  }
+  NumericVector result(sp_mat.ncol);
+  double* result_ptr = result.begin();
+  dispatch_na_policy(sp_mat, na_rm, [&](auto na_policy) -> void {
+    parallel_for_columns(sp_mat, n_threads, [&cv, &op, result_ptr, na_policy](R_len_t col_idx) -> void {
+      auto col = cv.column(col_idx, na_policy);
+      result_ptr[col_idx] = op(col.values, col.row_indices, col.number_of_zeros, col_idx);
+    });
+  });
   return result;
 }
 
 template<typename Functor>
-NumericMatrix reduce_matrix_num_matrix(S4 matrix, bool na_rm, R_len_t n_res_columns, bool transpose, Functor op){
-  dgCMatrixView sp_mat = wrap_dgCMatrix(matrix);
+NumericVector reduce_matrix_double_with_index(S4 matrix, bool na_rm, Functor op, int n_threads = get_n_threads()){
+  return reduce_matrix_double_with_index(wrap_dgCMatrix(matrix), na_rm, op, n_threads);
+}
+
+// The matrix reducers allocate the result once and op writes the result of
+// each column directly into it through an OutputSpan with n_res_columns
+// elements: the column col_idx of the (n_res_columns x ncol) result, or with
+// transpose = TRUE the row col_idx of the (ncol x n_res_columns) result.
+template<typename Functor>
+NumericMatrix reduce_matrix_num_matrix(const dgCMatrixView& sp_mat, bool na_rm, R_len_t n_res_columns, bool transpose, Functor op, int n_threads = get_n_threads()){
   ColumnView cv(&sp_mat);
-  std::vector<std::vector<double> > result;
-  result.reserve(sp_mat.ncol);
-  if(na_rm){
-    std::transform(cv.begin(), cv.end(), std::back_inserter(result),
-                   [op](ColumnView::col_container col) -> std::vector<double> {
-                     SkipNAVectorSubsetView<REALSXP> values_wrapper(&col.values);
-                     SkipNAVectorSubsetView<INTSXP> row_indices_wrapper(&col.row_indices);
-                     return op(values_wrapper, row_indices_wrapper, col.number_of_zeros);
-                   });
-  }else{
-    std::transform(cv.begin(), cv.end(), std::back_inserter(result),
-                   [op](ColumnView::col_container col) -> std::vector<double> {
-                     return op(col.values, col.row_indices, col.number_of_zeros);
-                   });
-  }
-  std::vector<double> result_flat = flatten(result);
-  if(transpose){
-    return Rcpp::transpose(NumericMatrix(n_res_columns, sp_mat.ncol, result_flat.begin()));
-  }else{
-    return NumericMatrix(n_res_columns, sp_mat.ncol, result_flat.begin());
-  }
+  R_len_t ncol = sp_mat.ncol;
+  NumericMatrix result = transpose ? NumericMatrix(ncol, n_res_columns) : NumericMatrix(n_res_columns, ncol);
+  double* result_ptr = result.begin();
+  dispatch_na_policy(sp_mat, na_rm, [&](auto na_policy) -> void {
+    parallel_for_columns(sp_mat, n_threads, [&cv, &op, result_ptr, ncol, n_res_columns, transpose, na_policy](R_len_t col_idx) -> void {
+      auto col = cv.column(col_idx, na_policy);
+      OutputSpan<double> out = transpose ? OutputSpan<double>(result_ptr + col_idx, n_res_columns, ncol) :
+                                           OutputSpan<double>(result_ptr + (R_xlen_t) col_idx * n_res_columns, n_res_columns);
+      op(col.values, col.row_indices, col.number_of_zeros, out);
+    });
+  });
+  return result;
+}
+
+template<typename Functor>
+NumericMatrix reduce_matrix_num_matrix(S4 matrix, bool na_rm, R_len_t n_res_columns, bool transpose, Functor op, int n_threads = get_n_threads()){
+  return reduce_matrix_num_matrix(wrap_dgCMatrix(matrix), na_rm, n_res_columns, transpose, op, n_threads);
+}
+
+template<typename Functor>
+NumericMatrix reduce_matrix_num_matrix_with_na(const dgCMatrixView& sp_mat, R_len_t n_res_columns, bool transpose, Functor op, int n_threads = get_n_threads()){
+  return reduce_matrix_num_matrix(sp_mat, false, n_res_columns, transpose, op, n_threads);
+}
+
+template<typename Functor>
+NumericMatrix reduce_matrix_num_matrix_with_na(S4 matrix, R_len_t n_res_columns, bool transpose, Functor op, int n_threads = get_n_threads()){
+  return reduce_matrix_num_matrix(matrix, false, n_res_columns, transpose, op, n_threads);
 }
 
+
 template<typename Functor>
-NumericMatrix reduce_matrix_num_matrix_with_na(S4 matrix, R_len_t n_res_columns, bool transpose, Functor op){
-  dgCMatrixView sp_mat = wrap_dgCMatrix(matrix);
+IntegerMatrix reduce_matrix_int_matrix(const dgCMatrixView& sp_mat, bool na_rm, R_len_t n_res_columns, bool transpose, Functor op, int n_threads = get_n_threads()){
   ColumnView cv(&sp_mat);
-  std::vector<std::vector<double> > result;
-  result.reserve(sp_mat.ncol);
-  std::transform(cv.begin(), cv.end(), std::back_inserter(result),
-                 [op](ColumnView::col_container col) -> std::vector<double> {
-                   return op(col.values, col.row_indices, col.number_of_zeros);
-                 });
-  std::vector<double> result_flat = flatten(result);
-  if(transpose){
-    return Rcpp::transpose(NumericMatrix(n_res_columns, sp_mat.ncol, result_flat.begin()));
-  }else{
-    return NumericMatrix(n_res_columns, sp_mat.ncol, result_flat.begin());
-  }
+  R_len_t ncol = sp_mat.ncol;
+  IntegerMatrix result = transpose ? IntegerMatrix(ncol, n_res_columns) : IntegerMatrix(n_res_columns, ncol);
+  int* result_ptr = result.begin();
+  dispatch_na_policy(sp_mat, na_rm, [&](auto na_policy) -> void {
+    parallel_for_columns(sp_mat, n_threads, [&cv, &op, result_ptr, ncol, n_res_columns, transpose, na_policy](R_len_t col_idx) -> void {
+      auto col = cv.column(col_idx, na_policy);
+      OutputSpan<int> out = transpose ? OutputSpan<int>(result_ptr + col_idx, n_res_columns, ncol) :
+                                        OutputSpan<int>(result_ptr + (R_xlen_t) col_idx * n_res_columns, n_res_columns);
+      op(col.values, col.row_indices, col.number_of_zeros, out);
+    });
+  });
+  return result;
+}
+
+template<typename Functor>
+IntegerMatrix reduce_matrix_int_matrix(S4 matrix, bool na_rm, R_len_t n_res_columns, bool transpose, Functor op, int n_threads = get_n_threads()){
+  return reduce_matrix_int_matrix(wrap_dgCMatrix(matrix), na_rm, n_res_columns, transpose, op, n_threads);
+}
+
+template<typename Functor>
+IntegerMatrix reduce_matrix_int_matrix_with_na(const dgCMatrixView& sp_mat, R_len_t n_res_columns, bool transpose, Functor op, int n_threads = get_n_threads()){
+  return reduce_matrix_int_matrix(sp_mat, false, n_res_columns, transpose, op, n_threads);
+}
+
+template<typename Functor>
+IntegerMatrix reduce_matrix_int_matrix_with_na(S4 matrix, R_len_t n_res_columns, bool transpose, Functor op, int n_threads = get_n_threads()){
+  return reduce_matrix_int_matrix(matrix, false, n_res_columns, transpose, op, n_threads);
 }
 
 
+
+// For results that are sparse themselves: op(values, row_indices,
+// number_of_zeros, out) pushes the non-zero results of a column into out
+// (a SparseOutput, see ColumnSpan.h). Every thread collects a contiguous range
+// of columns in its own SparseOutput, which are concatenated into a dgCMatrix
+// with n_res_rows rows at the end. With transpose = TRUE, the result is
+// transposed (one row per column of sp_mat).
 template<typename Functor>
-IntegerMatrix reduce_matrix_int_matrix(S4 matrix, bool na_rm, R_len_t n_res_columns, bool transpose, Functor op){
-  dgCMatrixView sp_mat = wrap_dgCMatrix(matrix);
+S4 reduce_matrix_sparse_matrix_with_na(const dgCMatrixView& sp_mat, R_len_t n_res_rows, bool transpose, Functor op, int n_threads = get_n_threads()){
   ColumnView cv(&sp_mat);
-  std::vector<std::vector<int> > result;
-  result.reserve(sp_mat.ncol);
-  if(na_rm){
-    std::transform(cv.begin(), cv.end(), std::back_inserter(result),
-                   [op](ColumnView::col_container col) -> std::vector<int> {
-                     SkipNAVectorSubsetView<REALSXP> values_wrapper(&col.values);
-                     SkipNAVectorSubsetView<INTSXP> row_indices_wrapper(&col.row_indices);
-                     return op(values_wrapper, row_indices_wrapper, col.number_of_zeros);
-                   });
-  }else{
-    std::transform(cv.begin(), cv.end(), std::back_inserter(result),
-                   [op](ColumnView::col_container col) -> std::vector<int> {
-                     return op(col.values, col.row_indices, col.number_of_zeros);
-                   });
-  }
-  std::vector<int> result_flat = flatten(result);
-  if(transpose){
-    return Rcpp::transpose(IntegerMatrix(n_res_columns, sp_mat.ncol, result_flat.begin()));
+  R_len_t ncol = sp_mat.ncol;
+  int n_chunks = (int) std::max<R_len_t>(std::min<R_len_t>(n_threads, ncol), 1);
+  std::vector<SparseOutput> chunk_results(n_chunks);
+  std::vector<R_xlen_t> col_nnz(ncol);
+  dispatch_na_policy(sp_mat, false, [&](auto na_policy) -> void {
+    parallel_for_column_chunks(sp_mat, n_chunks, [&cv, &op, &chunk_results, &col_nnz, na_policy](int chunk, R_len_t col_begin, R_len_t col_end) -> void {
+      SparseOutput& out = chunk_results[chunk];
+      for(R_len_t col_idx = col_begin; col_idx < col_end; ++col_idx){
+        size_t size_before = out.size();
+        auto col = cv.column(col_idx, na_policy);
+        op(col.values, col.row_indices, col.number_of_zeros, out);
+        col_nnz[col_idx] = out.size() - size_before;
+      }
+    });
+  });
+  IntegerVector col_ptrs(ncol + 1);
+  R_xlen_t nnz = 0;
+  for(R_len_t col_idx = 0; col_idx < ncol; ++col_idx){
+    nnz += col_nnz[col_idx];
+    if(nnz > std::numeric_limits<int>::max()){
+      throw std::range_error("The result has too many non-zero elements for a dgCMatrix");
+    }
+    col_ptrs[col_idx + 1] = (int) nnz;
+  }
+  NumericVector values = no_init(nnz);
+  IntegerVector row_indices = no_init(nnz);
+  R_xlen_t pos = 0;
+  for(const SparseOutput& out : chunk_results){
+    std::copy(out.values.begin(), out.values.end(), values.begin() + pos);
+    std::copy(out.row_indices.begin(), out.row_indices.end(), row_indices.begin() + pos);
+    pos += out.size();
+  }
+  dgCMatrixView result(n_res_rows, ncol, values, row_indices, col_ptrs);
+  return as_dgCMatrix(transpose ? transpose_dgCMatrixView(result) : result);
+}
+
+
+
+// Stacks the results of the row tiles (see reduce_row_tiles()): vectors are
+// concatenated, matrices (dense or dgCMatrix) bound by rows, or by columns if
+// by_column is TRUE, and lists element by element.
+template<int RTYPE>
+SEXP stack_dense_tiles(const std::vector<SEXP>& parts, bool by_column){
+  typedef typename Rcpp::traits::storage_type<RTYPE>::type T;
+  SEXP first = parts[0];
+  if(! Rf_isMatrix(first) || by_column){
+    R_xlen_t size = 0;
+    R_len_t ncol = 0;
+    for(SEXP part : parts){
+      size += Rf_xlength(part);
+      ncol += Rf_isMatrix(part) ? Rf_ncols(part) : 0;
+    }
+    Vector<RTYPE> result = no_init(size);
+    T* result_ptr = result.begin();
+    for(SEXP part : parts){
+      Vector<RTYPE> part_vec(part);
+      result_ptr = std::copy(part_vec.begin(), part_vec.end(), result_ptr);
+    }
+    if(Rf_isMatrix(first)){
+      result.attr("dim") = IntegerVector::create(Rf_nrows(first), ncol);
+    }
+    return result;
+  }
+  R_len_t nrow = 0;
+  R_len_t ncol = Rf_ncols(first);
+  for(SEXP part : parts){
+    nrow += Rf_nrows(part);
+  }
+  Matrix<RTYPE> result(nrow, ncol);
+  R_len_t row_offset = 0;
+  for(SEXP part : parts){
+    Matrix<RTYPE> part_mat(part);
+    for(R_len_t col = 0; col < ncol; ++col){
+      std::copy(part_mat.column(col).begin(), part_mat.column(col).end(), result.column(col).begin() + row_offset);
+    }
+    row_offset += part_mat.nrow();
+  }
+  return result;
+}
+
+S4 stack_sparse_tiles(const std::vector<SEXP>& parts, bool by_column){
+  std::vector<dgCMatrixView> views;
+  for(SEXP part : parts){
+    views.push_back(wrap_dgCMatrix(S4(part)));
+  }
+  R_len_t nrow = by_column ? views[0].nrow : 0;
+  R_len_t ncol = by_column ? 0 : views[0].ncol;
+  R_xlen_t nnz = 0;
+  for(const dgCMatrixView& view : views){
+    if(by_column){
+      ncol += view.ncol;
+    }else{
+      nrow += view.nrow;
+    }
+    nnz += view.stored_size();
+  }
+  if(nnz > std::numeric_limits<int>::max()){
+    throw std::range_error("The result has too many non-zero elements for a dgCMatrix");
+  }
+  NumericVector values = no_init(nnz);
+  IntegerVector row_indices = no_init(nnz);
+  std::vector<R_xlen_t> col_ptrs(ncol + 1, 0);
+  R_xlen_t pos = 0;
+  auto copy_column = [&](const dgCMatrixView& view, R_len_t col, int row_offset) -> void {
+    for(R_xlen_t i = view.col_begin(col); i < view.col_end(col); ++i, ++pos){
+      values[pos] = view.values_ptr[i];
+      row_indices[pos] = view.row_indices_ptr[i] + row_offset;
+    }
+  };
+  if(by_column){
+    R_len_t out_col = 0;
+    for(const dgCMatrixView& view : views){
+      for(R_len_t col = 0; col < view.ncol; ++col){
+        copy_column(view, col, 0);
+        col_ptrs[++out_col] = pos;
+      }
+    }
   }else{
-    return IntegerMatrix(n_res_columns, sp_mat.ncol, result_flat.begin());
+    for(R_len_t col = 0; col < ncol; ++col){
+      int row_offset = 0;
+      for(const dgCMatrixView& view : views){
+        copy_column(view, col, row_offset);
+        row_offset += view.nrow;
+      }
+      col_ptrs[col + 1] = pos;
+    }
+  }
+  return as_dgCMatrix(dgCMatrixView(nrow, ncol, values, row_indices, make_col_ptrs(col_ptrs)));
+}
+
+SEXP stack_row_tiles(const std::vector<SEXP>& parts, bool by_column){
+  SEXP first = parts[0];
+  if(TYPEOF(first) == VECSXP){
+    List result(Rf_xlength(first));
+    for(R_xlen_t k = 0; k < result.size(); ++k){
+      std::vector<SEXP> elements;
+      for(SEXP part : parts){
+        elements.push_back(VECTOR_ELT(part, k));
+      }
+      result[k] = stack_row_tiles(elements, by_column);
+    }
+    result.attr("names") = Rf_getAttrib(first, R_NamesSymbol);
+    return result;
+  }
+  if(Rf_isS4(first)){
+    return stack_sparse_tiles(parts, by_column);
+  }
+  switch(TYPEOF(first)){
+  case REALSXP: return stack_dense_tiles<REALSXP>(parts, by_column);
+  case INTSXP: return stack_dense_tiles<INTSXP>(parts, by_column);
+  case LGLSXP: return stack_dense_tiles<LGLSXP>(parts, by_column);
+  default: throw std::runtime_error("Cannot stack the row tiles of this result type");
   }
 }
 
+// The row functions run the column kernels on the transposed matrix:
+// col_impl(transposed, row_begin, row_end) gets the transpose of the rows
+// [row_begin, row_end) of sp_mat and returns their result. A matrix in memory
+// is transposed in one go, a view on a SparseStatsFile in row tiles (see
+// transpose_tile_rows()), so the transposed copy never holds more than one
+// tile of the file. by_column is TRUE if the result has one column (instead
+// of one row or element) per row of sp_mat.
 template<typename Functor>
-IntegerMatrix reduce_matrix_int_matrix_with_na(S4 matrix, R_len_t n_res_columns, bool transpose, Functor op){
-  dgCMatrixView sp_mat = wrap_dgCMatrix(matrix);
-  ColumnView cv(&sp_mat);
-  std::vector<std::vector<int> > result;
-  result.reserve(sp_mat.ncol);
-  std::transform(cv.begin(), cv.end(), std::back_inserter(result),
-                 [op](ColumnView::col_container col) -> std::vector<int> {
-                   return op(col.values, col.row_indices, col.number_of_zeros);
-                 });
-  std::vector<int> result_flat = flatten(result);
-  if(transpose){
-    return Rcpp::transpose(IntegerMatrix(n_res_columns, sp_mat.ncol, result_flat.begin()));
-  }else{
-    return IntegerMatrix(n_res_columns, sp_mat.ncol, result_flat.begin());
+auto reduce_row_tiles(const dgCMatrixView& sp_mat, Functor col_impl, bool by_column = false) -> decltype(col_impl(sp_mat, 0, 0)) {
+  typedef decltype(col_impl(sp_mat, 0, 0)) Result;
+  R_len_t tile_rows = transpose_tile_rows(sp_mat);
+  if(tile_rows >= sp_mat.nrow){
+    return col_impl(transpose_dgCMatrixView(sp_mat), 0, sp_mat.nrow);
   }
+  std::vector<R_xlen_t> cursors;
+  std::vector<Result> results;
+  for(R_len_t row_begin = 0; row_begin < sp_mat.nrow; row_begin += tile_rows){
+    R_len_t row_end = std::min(row_begin + tile_rows, sp_mat.nrow);
+    results.push_back(col_impl(transpose_dgCMatrixView(sp_mat, row_begin, row_end, cursors), row_begin, row_end));
+  }
+  return Result(stack_row_tiles(std::vector<SEXP>(results.begin(), results.end()), by_column));
 }
 
 
@@ -200,21 +366,19 @@ IntegerMatrix reduce_matrix_int_matrix_with_na(S4 matrix, R_len_t n_res_columns,
 /*---------------Simple Aggregation Functions-----------------*/
 
 // [[Rcpp::export]]
-NumericVector dgCMatrix_colSums2(S4 matrix, bool na_rm){
-  return reduce_matrix_double(matrix, na_rm, [](auto values, auto row_indices, int number_of_zeros) -> double{
-    return sum_stable(values);
+NumericVector dgCMatrix_colSums2(S4 matrix, bool na_rm, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return dispatch_sparse_view(matrix, rows, cols, [na_rm](const auto& sp_mat) -> NumericVector {
+    return reduce_matrix_double(sp_mat, na_rm, [](auto values, auto row_indices, int number_of_zeros) -> double{
+      return sum_stable(values);
+    });
   });
 }
 
 
 template<typename Iterator>
 inline double sp_mean(Iterator values, int number_of_zeros){
-  LDOUBLE sum = 0.0;
-  int size = number_of_zeros;
-  for(double d : values){
-    R_CHECK_USER_INTERRUPT(++size);
-    sum += d;
-  }
+  double sum = sum_stable(values);
+  R_len_t size = values.size() + number_of_zeros;
   if(NumericVector::is_na(sum)){
     return sum;
   }else if(size == 0){
@@ -225,43 +389,70 @@ inline double sp_mean(Iterator values, int number_of_zeros){
 }
 
 // [[Rcpp::export]]
-NumericVector dgCMatrix_colMeans2(S4 matrix, bool na_rm){
-  return reduce_matrix_double(matrix, na_rm, [](auto values, auto row_indices, int number_of_zeros) -> double{
-    return sp_mean(values, number_of_zeros);
+NumericVector dgCMatrix_colMeans2(S4 matrix, bool na_rm, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return dispatch_sparse_view(matrix, rows, cols, [na_rm](const auto& sp_mat) -> NumericVector {
+    return reduce_matrix_double(sp_mat, na_rm, [](auto values, auto row_indices, int number_of_zeros) -> double{
+      return sp_mean(values, number_of_zeros);
+    });
   });
 }
 
 
-// [[Rcpp::export]]
-NumericVector dgCMatrix_colMedians(S4 matrix, bool na_rm){
-  return reduce_matrix_double(matrix, na_rm, [na_rm](auto values, auto row_indices, int number_of_zeros) -> double{
-    if(! na_rm){
-      bool any_na = is_any_na(values);
-      if(any_na){
-        return NA_REAL;
-      }
+NumericVector colMedians_impl(const dgCMatrixView& sp_mat, bool na_rm){
+  return reduce_matrix_double(sp_mat, na_rm, [](auto values, auto row_indices, int number_of_zeros) -> double{
+    if(is_any_na(values)){
+      return NA_REAL;
     }
-    R_len_t size = values.size();
-    if(number_of_zeros > size){
-      // Easy escape hatch
-      return 0.0;
+    return quantile_sparse_select(values, number_of_zeros, 0.5);
+  });
+}
+
+// [[Rcpp::export]]
+NumericVector dgCMatrix_colMedians(S4 matrix, bool na_rm, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return colMedians_impl(wrap_dgCMatrix(matrix, rows, cols), na_rm);
+}
+
+// [[Rcpp::export]]
+NumericVector dgCMatrix_rowMedians(S4 matrix, bool na_rm, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return reduce_row_tiles(wrap_dgCMatrix(matrix, rows, cols), [&](const dgCMatrixView& tile, R_len_t, R_len_t) {
+    return colMedians_impl(tile, na_rm);
+  });
+}
+
+
+NumericVector colIQRs_impl(const dgCMatrixView& sp_mat, bool na_rm){
+  return reduce_matrix_double(sp_mat, na_rm, [](auto values, auto row_indices, int number_of_zeros) -> double{
+    if(is_any_na(values)){
+      return NA_REAL;
     }
-    if(size + number_of_zeros == 0){
+    if(values.size() + number_of_zeros == 0){
       return NA_REAL;
     }
-    return quantile_sparse_impl(values, number_of_zeros, 0.5);
+    return quantile_sparse_select(values, number_of_zeros, 0.75) - quantile_sparse_select(values, number_of_zeros, 0.25);
+  });
+}
+
+// [[Rcpp::export]]
+NumericVector dgCMatrix_colIQRs(S4 matrix, bool na_rm, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return colIQRs_impl(wrap_dgCMatrix(matrix, rows, cols), na_rm);
+}
+
+// [[Rcpp::export]]
+NumericVector dgCMatrix_rowIQRs(S4 matrix, bool na_rm, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return reduce_row_tiles(wrap_dgCMatrix(matrix, rows, cols), [&](const dgCMatrixView& tile, R_len_t, R_len_t) {
+    return colIQRs_impl(tile, na_rm);
   });
 }
 
 
 // [[Rcpp::export]]
-NumericVector dgCMatrix_colVars(S4 matrix, bool na_rm, Nullable<NumericVector> center){
+NumericVector dgCMatrix_colVars(S4 matrix, bool na_rm, Nullable<NumericVector> center, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
   bool center_provided = center.isNotNull();
   NumericVector center_vec(0);
   if(center_provided){
     center_vec = Rcpp::as<NumericVector>(center.get());
   }
-  return reduce_matrix_double_with_index(matrix, na_rm, [center_vec, center_provided](auto values, auto row_indices, int number_of_zeros, int col_idx) -> double{
+  return reduce_matrix_double_with_index(wrap_dgCMatrix(matrix, rows, cols), na_rm, [center_vec, center_provided](auto values, auto row_indices, int number_of_zeros, int col_idx) -> double{
     double mean = 0;
     if(! center_provided){
       mean = sp_mean(values, number_of_zeros);
@@ -271,14 +462,8 @@ NumericVector dgCMatrix_colVars(S4 matrix, bool na_rm, Nullable<NumericVector> c
     if(ISNA(mean)){
       return NA_REAL;
     }
-    double sigma2 = number_of_zeros * mean * mean;
-    double diff = 0.0;
-    int size = number_of_zeros;
-    for(double d : values){
-      R_CHECK_USER_INTERRUPT(++size);
-      diff = d - mean;
-      sigma2 += diff * diff;
-    }
+    double sigma2 = number_of_zeros * mean * mean + simd_sum_squared_deviations(values.begin(), values.size(), mean);
+    R_len_t size = values.size() + number_of_zeros;
     if(size <= 1){
       return NA_REAL;    // Yes, var(3) actually returns NA instead of NaN
     }else{
@@ -288,19 +473,15 @@ NumericVector dgCMatrix_colVars(S4 matrix, bool na_rm, Nullable<NumericVector> c
 }
 
 
-// [[Rcpp::export]]
-NumericVector dgCMatrix_colMads(S4 matrix, bool na_rm, double scale_factor, Nullable<NumericVector> center){
+NumericVector colMads_impl(const dgCMatrixView& sp_mat, bool na_rm, double scale_factor, Nullable<NumericVector> center){
   bool center_provided = center.isNotNull();
   NumericVector center_vec(0);
   if(center_provided){
     center_vec = Rcpp::as<NumericVector>(center.get());
   }
-  return reduce_matrix_double_with_index(matrix, na_rm, [na_rm, scale_factor, center_vec, center_provided](auto values, auto row_indices, int number_of_zeros, int col_idx) -> double{
-    if(! na_rm){
-      bool any_na = is_any_na(values);
-      if(any_na){
-        return NA_REAL;
-      }
+  return reduce_matrix_double_with_index(sp_mat, na_rm, [scale_factor, center_vec, center_provided](auto values, auto row_indices, int number_of_zeros, int col_idx) -> double{
+    if(is_any_na(values)){
+      return NA_REAL;
     }
     R_len_t size = values.size();
     if(! center_provided && number_of_zeros > size){
@@ -314,28 +495,51 @@ NumericVector dgCMatrix_colMads(S4 matrix, bool na_rm, double scale_factor, Null
     if(center_provided){
       med = center_vec[col_idx];
     }else{
-      med = quantile_sparse_impl(values, number_of_zeros, 0.5);
+      med = quantile_sparse_select(values, number_of_zeros, 0.5);
     }
-    NumericVector complete_vector(size + number_of_zeros, std::abs(med));
-    auto val_it = values.begin();
-    auto val_end = values.end();
-    auto ind_it = row_indices.begin();
-    auto ind_end = row_indices.end();
-    while(val_it != val_end && ind_it != ind_end){
-      complete_vector[*ind_it] = std::abs(*val_it - med);
-      ++val_it;
-      ++ind_it;
+    if(ISNAN(med)){
+      return NA_REAL;
+    }
+    // All zeros have the same deviation |0 - med|, so they stay a single
+    // atom and only the stored values are transformed
+    thread_local std::vector<double> deviations;
+    deviations.resize(size);
+    std::transform(values.begin(), values.end(), deviations.begin(), [med](double v) -> double {
+      return std::abs(v - med);
+    });
+    if(std::any_of(deviations.begin(), deviations.end(), [](double d) -> bool { return ISNAN(d); })){
+      return NA_REAL;
     }
-    return median(complete_vector) * scale_factor;
+    ColumnSpan<double> deviation_span(deviations.data(), size);
+    return median_with_atom(deviation_span, std::abs(med), number_of_zeros) * scale_factor;
   });
 }
 
-
+// [[Rcpp::export]]
+NumericVector dgCMatrix_colMads(S4 matrix, bool na_rm, double scale_factor, Nullable<NumericVector> center, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return colMads_impl(wrap_dgCMatrix(matrix, rows, cols), na_rm, scale_factor, center);
+}
 
 // [[Rcpp::export]]
-NumericVector dgCMatrix_colMins(S4 matrix, bool na_rm){
-  return reduce_matrix_double(matrix, na_rm, [na_rm](auto values, auto row_indices, int number_of_zeros) -> double{
-    if(! na_rm && is_any_na(values)){
+NumericVector dgCMatrix_rowMads(S4 matrix, bool na_rm, double scale_factor, Nullable<NumericVector> center, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return reduce_row_tiles(wrap_dgCMatrix(matrix, rows, cols), [&](const dgCMatrixView& tile, R_len_t row_begin, R_len_t row_end) {
+    Nullable<NumericVector> tile_center = center;
+    if(center.isNotNull()){
+      NumericVector center_vec(center.get());
+      if(center_vec.size() < row_end){
+        throw std::range_error("center must have one entry per row");
+      }
+      tile_center = NumericVector(center_vec.begin() + row_begin, center_vec.begin() + row_end);
+    }
+    return colMads_impl(tile, na_rm, scale_factor, tile_center);
+  });
+}
+
+
+
+NumericVector colMins_impl(const dgCMatrixView& sp_mat, bool na_rm){
+  return reduce_matrix_double(sp_mat, na_rm, [](auto values, auto row_indices, int number_of_zeros) -> double{
+    if(is_any_na(values)){
       return NA_REAL;
     }
     auto min_iter = std::min_element(values.begin(), values.end(), [](double a, double b) -> bool {
@@ -350,9 +554,20 @@ NumericVector dgCMatrix_colMins(S4 matrix, bool na_rm){
 }
 
 // [[Rcpp::export]]
-NumericVector dgCMatrix_colMaxs(S4 matrix, bool na_rm){
-  return reduce_matrix_double(matrix, na_rm, [na_rm](auto values, auto row_indices, int number_of_zeros) -> double{
-    if(! na_rm && is_any_na(values)){
+NumericVector dgCMatrix_colMins(S4 matrix, bool na_rm, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return colMins_impl(wrap_dgCMatrix(matrix, rows, cols), na_rm);
+}
+
+// [[Rcpp::export]]
+NumericVector dgCMatrix_rowMins(S4 matrix, bool na_rm, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return reduce_row_tiles(wrap_dgCMatrix(matrix, rows, cols), [&](const dgCMatrixView& tile, R_len_t, R_len_t) {
+    return colMins_impl(tile, na_rm);
+  });
+}
+
+NumericVector colMaxs_impl(const dgCMatrixView& sp_mat, bool na_rm){
+  return reduce_matrix_double(sp_mat, na_rm, [](auto values, auto row_indices, int number_of_zeros) -> double{
+    if(is_any_na(values)){
       return NA_REAL;
     }
     auto max_iter = std::max_element(values.begin(), values.end(), [](double a, double b) -> bool {
@@ -366,15 +581,23 @@ NumericVector dgCMatrix_colMaxs(S4 matrix, bool na_rm){
   });
 }
 
+// [[Rcpp::export]]
+NumericVector dgCMatrix_colMaxs(S4 matrix, bool na_rm, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return colMaxs_impl(wrap_dgCMatrix(matrix, rows, cols), na_rm);
+}
 
 // [[Rcpp::export]]
-NumericVector dgCMatrix_colOrderStats(S4 matrix, int which, bool na_rm){
-  return reduce_matrix_double(matrix, na_rm, [na_rm, which](auto values, auto row_indices, int number_of_zeros) -> double{
-    if(! na_rm){
-      bool any_na = is_any_na(values);
-      if(any_na){
-        return NA_REAL;
-      }
+NumericVector dgCMatrix_rowMaxs(S4 matrix, bool na_rm, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return reduce_row_tiles(wrap_dgCMatrix(matrix, rows, cols), [&](const dgCMatrixView& tile, R_len_t, R_len_t) {
+    return colMaxs_impl(tile, na_rm);
+  });
+}
+
+
+NumericVector colOrderStats_impl(const dgCMatrixView& sp_mat, int which, bool na_rm){
+  return reduce_matrix_double(sp_mat, na_rm, [which](auto values, auto row_indices, int number_of_zeros) -> double{
+    if(is_any_na(values)){
+      return NA_REAL;
     }
     R_len_t size = values.size();
     double used_which = std::min(which, size + number_of_zeros);
@@ -383,115 +606,127 @@ NumericVector dgCMatrix_colOrderStats(S4 matrix, int which, bool na_rm){
     }else if(size == 0){
       return 0.0;
     }
-    std::vector<double> sorted_values;
-    std::copy(values.begin(), values.end(), std::back_inserter(sorted_values));
-    std::sort(sorted_values.begin(), sorted_values.end(),[](double i1, double i2){
-      if(Rcpp::NumericVector::is_na(i1)) return false;
-      if(Rcpp::NumericVector::is_na(i2)) return true;
-      return i1 < i2;
-    });
-    bool left_of_zero = sorted_values[0] < 0;
-    bool right_of_zero = !left_of_zero && number_of_zeros == 0;
-    int zero_counter = ! left_of_zero && ! right_of_zero;
-    int vec_counter = 0;
-    for(int i = 0; i < sorted_values.size() + number_of_zeros; i++){
-      // Rcout << i << " " << vec_counter << " " << zero_counter << " " << left_of_zero << " " << right_of_zero << " " << std::endl;
-      if(i == used_which - 1){
-        if(! left_of_zero && ! right_of_zero){
-          return 0;
-        }else{
-          return sorted_values[vec_counter];
-        }
-      }
-
-      if(left_of_zero){
-        vec_counter++;
-        if(vec_counter == size || sorted_values[vec_counter] > 0){
-          left_of_zero = false;
-        }
-      }
-      if(right_of_zero){
-        vec_counter++;
-      }
-      if(! left_of_zero && ! right_of_zero){
-        zero_counter++;
-        if(zero_counter > number_of_zeros){
-          right_of_zero = true;
-        }
-      }
-    }
-    return NA_REAL;
+    return select_sparse_rank(values, number_of_zeros, used_which - 1);
   });
 }
 
+// [[Rcpp::export]]
+NumericVector dgCMatrix_colOrderStats(S4 matrix, int which, bool na_rm, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return colOrderStats_impl(wrap_dgCMatrix(matrix, rows, cols), which, na_rm);
+}
 
 // [[Rcpp::export]]
-NumericVector dgCMatrix_colLogSumExps(S4 matrix, bool na_rm){
-  return reduce_matrix_double(matrix, na_rm, [](auto values, auto row_indices, int number_of_zeros) -> double{
-    auto max_iter = std::max_element(values.begin(), values.end(), [](double a, double b) -> bool {
-      return a < b;
-    });
-    if(max_iter == values.end()){
+NumericVector dgCMatrix_rowOrderStats(S4 matrix, int which, bool na_rm, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return reduce_row_tiles(wrap_dgCMatrix(matrix, rows, cols), [&](const dgCMatrixView& tile, R_len_t, R_len_t) {
+    return colOrderStats_impl(tile, which, na_rm);
+  });
+}
+
+
+NumericVector colLogSumExps_impl(const dgCMatrixView& sp_mat, bool na_rm){
+  return reduce_matrix_double(sp_mat, na_rm, [](auto values, auto row_indices, int number_of_zeros) -> double{
+    if(values.is_empty()){
       return number_of_zeros > 0 ? log(number_of_zeros) : R_NegInf;
     }else{
-      double max = *max_iter;
-      if(NumericVector::is_na(max)){
-        return max;
+      if(is_any_na(values)){
+        return NA_REAL;
       }
+      double max = *std::max_element(values.begin(), values.end());
       if(max == R_PosInf){
         return R_PosInf;
       }
       if(max == R_NegInf){
         return log(number_of_zeros);
       }
-      double sum = std::accumulate(values.begin(), values.end(), 0.0, [max](double a, double b) -> double {
-        return a + exp(b-max);
-      });
+      double sum = simd_sum_exp(values.begin(), values.size(), max);
       sum += exp(-max) * number_of_zeros;
       return max + log(sum);
     }
   });
 }
 
+// [[Rcpp::export]]
+NumericVector dgCMatrix_colLogSumExps(S4 matrix, bool na_rm, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return colLogSumExps_impl(wrap_dgCMatrix(matrix, rows, cols), na_rm);
+}
 
 // [[Rcpp::export]]
-NumericVector dgCMatrix_colProds(S4 matrix, bool na_rm){
-  return reduce_matrix_double(matrix, na_rm, [na_rm](auto values, auto row_indices, int number_of_zeros) -> double {
+NumericVector dgCMatrix_rowLogSumExps(S4 matrix, bool na_rm, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return reduce_row_tiles(wrap_dgCMatrix(matrix, rows, cols), [&](const dgCMatrixView& tile, R_len_t, R_len_t) {
+    return colLogSumExps_impl(tile, na_rm);
+  });
+}
+
+
+NumericVector colProds_impl(const dgCMatrixView& sp_mat, bool na_rm){
+  return reduce_matrix_double(sp_mat, na_rm, [](auto values, auto row_indices, int number_of_zeros) -> double {
+    if(is_any_na(values)){
+      return NA_REAL;
+    }
     bool any_inf = std::any_of(values.begin(), values.end(), [](const double d) -> bool {
       return d == R_PosInf || d == R_NegInf;
     });
-    if(na_rm){
-      if(number_of_zeros > 0 && !any_inf){
-        return 0.0;
-      }else if(number_of_zeros > 0 && any_inf){
-        return R_NaN;
-      }else{
-        return std::accumulate(values.begin(), values.end(), 1.0, [](double a, double b) -> double { return a * b;});
-      }
+    if(number_of_zeros > 0 && !any_inf){
+      return 0.0;
+    }else if(number_of_zeros > 0 && any_inf){
+      return R_NaN;
     }else{
-      bool any_na = is_any_na(values);
-      if(any_na){
-        return NA_REAL;
-      }else{
-        if(number_of_zeros > 0 && !any_inf){
-          return 0.0;
-        }else if(number_of_zeros > 0 && any_inf){
-          return R_NaN;
-        }else{
-          return std::accumulate(values.begin(), values.end(), 1.0, [](double a, double b) { return a * b; });
-        }
-      }
+      return std::accumulate(values.begin(), values.end(), 1.0, [](double a, double b) -> double { return a * b;});
     }
   });
 }
 
+// [[Rcpp::export]]
+NumericVector dgCMatrix_colProds(S4 matrix, bool na_rm, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return colProds_impl(wrap_dgCMatrix(matrix, rows, cols), na_rm);
+}
+
+// [[Rcpp::export]]
+NumericVector dgCMatrix_rowProds(S4 matrix, bool na_rm, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return reduce_row_tiles(wrap_dgCMatrix(matrix, rows, cols), [&](const dgCMatrixView& tile, R_len_t, R_len_t) {
+    return colProds_impl(tile, na_rm);
+  });
+}
+
+
+
+// Several statistics from one pass over each column. The result has one
+// column per entry of stats.
+template<int RTYPE>
+NumericMatrix colSummary_impl(const SparseMatrixView<RTYPE>& sp_mat, const std::vector<SummaryStat>& stat_codes, bool na_rm){
+  bool need_var = needs_summary_stat(stat_codes, SummaryStat::Var);
+  bool need_sum = need_var || needs_summary_stat(stat_codes, SummaryStat::Sum) || needs_summary_stat(stat_codes, SummaryStat::Mean);
+  SparseColumnView<RTYPE> cv(&sp_mat);
+  R_len_t ncol = sp_mat.ncol;
+  R_len_t nrow = sp_mat.nrow;
+  NumericMatrix result(ncol, stat_codes.size());
+  double* result_ptr = result.begin();
+  dispatch_na_policy(sp_mat, na_rm, [&](auto na_policy) -> void {
+    parallel_for_columns(sp_mat, get_n_threads(), [&cv, &stat_codes, result_ptr, ncol, nrow, need_sum, need_var, na_policy](R_len_t col_idx) -> void {
+      auto col = cv.column(col_idx, na_policy);
+      SummaryResult res = summarize_column(col.values, col.number_of_zeros, nrow - col.number_of_zeros, need_sum, need_var);
+      for(size_t k = 0; k < stat_codes.size(); ++k){
+        result_ptr[col_idx + k * ncol] = res.get(stat_codes[k]);
+      }
+    });
+  });
+  return result;
+}
+
+// [[Rcpp::export]]
+NumericMatrix dgCMatrix_colSummary(S4 matrix, bool na_rm, CharacterVector stats, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  std::vector<SummaryStat> stat_codes = parse_summary_stats(stats);
+  return dispatch_sparse_view(matrix, rows, cols, [&stat_codes, na_rm](const auto& sp_mat) -> NumericMatrix {
+    return colSummary_impl(sp_mat, stat_codes, na_rm);
+  });
+}
 
 
 /*---------------Weighted Aggregation Functions---------------*/
 
 
 template<typename Iterator, typename RIIterator>
-inline double sp_weighted_mean(Iterator values, int number_of_zeros, NumericVector weights, RIIterator row_indices, double total_weights, bool na_rm){
+inline double sp_weighted_mean(Iterator values, int number_of_zeros, const NumericVector& weights, RIIterator row_indices, double total_weights, bool na_rm){
   LDOUBLE accum = 0.0;
   double remaining_weights = total_weights;
   auto val_it = values.begin();
@@ -522,24 +757,34 @@ inline double sp_weighted_mean(Iterator values, int number_of_zeros, NumericVect
 }
 
 template<typename Iterator, typename RIIterator>
-inline double sp_weighted_mean(Iterator values, int number_of_zeros, NumericVector weights, RIIterator row_indices, bool na_rm){
+inline double sp_weighted_mean(Iterator values, int number_of_zeros, const NumericVector& weights, RIIterator row_indices, bool na_rm){
   return sp_weighted_mean(values, number_of_zeros, weights, sum(weights), na_rm);
 }
 
 
-// [[Rcpp::export]]
-NumericVector dgCMatrix_colWeightedMeans(S4 matrix, NumericVector weights, bool na_rm){
+NumericVector colWeightedMeans_impl(const dgCMatrixView& sp_mat, NumericVector weights, bool na_rm){
   double total_weights = sum(weights);
-  return reduce_matrix_double(matrix, false, [weights, total_weights, na_rm](auto values, auto row_indices, int number_of_zeros) -> double{
+  return reduce_matrix_double(sp_mat, false, [weights, total_weights, na_rm](auto values, auto row_indices, int number_of_zeros) -> double{
     return sp_weighted_mean(values, number_of_zeros, weights, row_indices, total_weights, na_rm);
   });
 }
 
+// [[Rcpp::export]]
+NumericVector dgCMatrix_colWeightedMeans(S4 matrix, NumericVector weights, bool na_rm, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return colWeightedMeans_impl(wrap_dgCMatrix(matrix, rows, cols), weights, na_rm);
+}
 
 // [[Rcpp::export]]
-NumericVector dgCMatrix_colWeightedVars(S4 matrix, NumericVector weights, bool na_rm){
+NumericVector dgCMatrix_rowWeightedMeans(S4 matrix, NumericVector weights, bool na_rm, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return reduce_row_tiles(wrap_dgCMatrix(matrix, rows, cols), [&](const dgCMatrixView& tile, R_len_t, R_len_t) {
+    return colWeightedMeans_impl(tile, weights, na_rm);
+  });
+}
+
+
+NumericVector colWeightedVars_impl(const dgCMatrixView& sp_mat, NumericVector weights, bool na_rm){
   double total_weights = sum(weights);
-  return reduce_matrix_double(matrix, false, [weights, total_weights, na_rm](auto values, auto row_indices, int number_of_zeros) -> double{
+  return reduce_matrix_double(sp_mat, false, [weights, total_weights, na_rm](auto values, auto row_indices, int number_of_zeros) -> double{
     double mean = sp_weighted_mean(values, number_of_zeros, weights, row_indices, total_weights, na_rm);
     if(ISNA(mean)){
       return NA_REAL;
@@ -578,44 +823,155 @@ NumericVector dgCMatrix_colWeightedVars(S4 matrix, NumericVector weights, bool n
   });
 }
 
-
-/*---------------Simple Detect Functions-----------------*/
+// [[Rcpp::export]]
+NumericVector dgCMatrix_colWeightedVars(S4 matrix, NumericVector weights, bool na_rm, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return colWeightedVars_impl(wrap_dgCMatrix(matrix, rows, cols), weights, na_rm);
+}
 
 // [[Rcpp::export]]
-IntegerVector dgCMatrix_colCounts(S4 matrix, double value, bool na_rm){
-  return reduce_matrix_int(matrix, na_rm, [value, na_rm](auto values, auto row_indices, int number_of_zeros) -> int{
-    if(na_rm && value == 0.0){
-      return number_of_zeros;
-    }else if(na_rm){
-      return std::count(values.begin(), values.end(), value);
-    }else{
-      bool contains_na = std::any_of(values.begin(), values.end(), [](const double d) -> bool{
-        return NumericVector::is_na(d);
-      });
-      if(! contains_na){  // No NA's in the vector
-        if(value == 0.0){
-          return number_of_zeros;
-        }else{
-          return std::count(values.begin(), values.end(), value);
-        }
-      }else{
-        return NA_REAL;
+NumericVector dgCMatrix_rowWeightedVars(S4 matrix, NumericVector weights, bool na_rm, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return reduce_row_tiles(wrap_dgCMatrix(matrix, rows, cols), [&](const dgCMatrixView& tile, R_len_t, R_len_t) {
+    return colWeightedVars_impl(tile, weights, na_rm);
+  });
+}
+
+
+// Fills entries with the (value, weight) pairs of a column. The implicit zeros
+// are added as a single pair, whose weight is total_weights minus the weights
+// of all stored entries. Returns false if the column contains a NA and
+// na_rm = FALSE.
+template<typename Iterator, typename RIIterator>
+inline bool sp_weighted_entries(Iterator values, RIIterator row_indices, int number_of_zeros, const NumericVector& weights,
+                                double total_weights, bool na_rm, std::vector<std::pair<double, double> >& entries){
+  entries.clear();
+  LDOUBLE zero_weights = total_weights;
+  auto val_it = values.begin();
+  auto val_end = values.end();
+  auto ind_it = row_indices.begin();
+  auto ind_end = row_indices.end();
+  while(val_it != val_end && ind_it != ind_end){
+    double v = *val_it;
+    double w = weights[*ind_it];
+    zero_weights -= w;
+    if(NumericVector::is_na(v)){
+      if(! na_rm){
+        return false;
       }
+    }else{
+      entries.emplace_back(v, w);
     }
+    ++val_it;
+    ++ind_it;
+  }
+  if(number_of_zeros > 0){
+    entries.emplace_back(0.0, zero_weights);
+  }
+  return true;
+}
+
+template<typename Iterator, typename RIIterator>
+inline double sp_weighted_median(Iterator values, RIIterator row_indices, int number_of_zeros, const NumericVector& weights,
+                                 double total_weights, bool na_rm){
+  std::vector<std::pair<double, double> >& entries = weighted_selection_buffer();
+  if(! sp_weighted_entries(values, row_indices, number_of_zeros, weights, total_weights, na_rm, entries)){
+    return NA_REAL;
+  }
+  return weighted_median_select(entries);
+}
+
+template<typename Iterator, typename RIIterator>
+inline double sp_weighted_mad(Iterator values, RIIterator row_indices, int number_of_zeros, const NumericVector& weights,
+                              double total_weights, bool na_rm, double scale_factor){
+  std::vector<std::pair<double, double> >& entries = weighted_selection_buffer();
+  if(! sp_weighted_entries(values, row_indices, number_of_zeros, weights, total_weights, na_rm, entries)){
+    return NA_REAL;
+  }
+  if(entries.empty()){
+    return NA_REAL;
+  }
+  double center = weighted_median_select(entries);
+  if(NumericVector::is_na(center) || std::isinf(center)){
+    // One of values must be Inf, thus Inf - Inf = NaN --> whole result is unknowable
+    return NA_REAL;
+  }
+  // weighted_median_select() only reorders and drops pairs without weight,
+  // which do not count for the deviations either.
+  for(auto& e : entries){
+    e.first = std::abs(e.first - center);
+  }
+  return scale_factor * weighted_median_select(entries);
+}
+
+
+NumericVector colWeightedMedians_impl(const dgCMatrixView& sp_mat, NumericVector weights, bool na_rm){
+  double total_weights = sum(weights);
+  return reduce_matrix_double(sp_mat, false, [weights, total_weights, na_rm](auto values, auto row_indices, int number_of_zeros) -> double{
+    return sp_weighted_median(values, row_indices, number_of_zeros, weights, total_weights, na_rm);
+  });
+}
+
+// [[Rcpp::export]]
+NumericVector dgCMatrix_colWeightedMedians(S4 matrix, NumericVector weights, bool na_rm, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return colWeightedMedians_impl(wrap_dgCMatrix(matrix, rows, cols), weights, na_rm);
+}
+
+// [[Rcpp::export]]
+NumericVector dgCMatrix_rowWeightedMedians(S4 matrix, NumericVector weights, bool na_rm, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return reduce_row_tiles(wrap_dgCMatrix(matrix, rows, cols), [&](const dgCMatrixView& tile, R_len_t, R_len_t) {
+    return colWeightedMedians_impl(tile, weights, na_rm);
   });
 }
 
+
+NumericVector colWeightedMads_impl(const dgCMatrixView& sp_mat, NumericVector weights, bool na_rm, double scale_factor){
+  double total_weights = sum(weights);
+  return reduce_matrix_double(sp_mat, false, [weights, total_weights, na_rm, scale_factor](auto values, auto row_indices, int number_of_zeros) -> double{
+    return sp_weighted_mad(values, row_indices, number_of_zeros, weights, total_weights, na_rm, scale_factor);
+  });
+}
+
+// [[Rcpp::export]]
+NumericVector dgCMatrix_colWeightedMads(S4 matrix, NumericVector weights, bool na_rm, double scale_factor, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return colWeightedMads_impl(wrap_dgCMatrix(matrix, rows, cols), weights, na_rm, scale_factor);
+}
+
 // [[Rcpp::export]]
-LogicalVector dgCMatrix_colAnyNAs(S4 matrix){
-  return reduce_matrix_lgl(matrix, false, [](auto values, auto row_indices, int number_of_zeros) -> int{
-    return is_any_na(values);
+NumericVector dgCMatrix_rowWeightedMads(S4 matrix, NumericVector weights, bool na_rm, double scale_factor, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return reduce_row_tiles(wrap_dgCMatrix(matrix, rows, cols), [&](const dgCMatrixView& tile, R_len_t, R_len_t) {
+    return colWeightedMads_impl(tile, weights, na_rm, scale_factor);
   });
 }
 
 
+/*---------------Simple Detect Functions-----------------*/
+
+// [[Rcpp::export]]
+IntegerVector dgCMatrix_colCounts(S4 matrix, double value, bool na_rm, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return dispatch_sparse_view(matrix, rows, cols, [value, na_rm](const auto& sp_mat) -> IntegerVector {
+    return reduce_matrix_int(sp_mat, na_rm, [value](auto values, auto row_indices, int number_of_zeros) -> int{
+      if(is_any_na(values)){
+        return NA_INTEGER;
+      }else{
+        int implicit_matches = value == 0.0 ? number_of_zeros : 0;
+        return implicit_matches + std::count(values.begin(), values.end(), value);
+      }
+    });
+  });
+}
+
 // [[Rcpp::export]]
-LogicalVector dgCMatrix_colAnys(S4 matrix, double value, bool na_rm){
-  return reduce_matrix_lgl(matrix, na_rm, [value, na_rm](auto values, auto row_indices, int number_of_zeros) -> int{
+LogicalVector dgCMatrix_colAnyNAs(S4 matrix, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return dispatch_sparse_view(matrix, rows, cols, [](const auto& sp_mat) -> LogicalVector {
+    return reduce_matrix_lgl(sp_mat, false, [](auto values, auto row_indices, int number_of_zeros) -> int{
+      return is_any_na(values);
+    });
+  });
+}
+
+
+template<int RTYPE>
+LogicalVector colAnys_impl(const SparseMatrixView<RTYPE>& sp_mat, double value, bool na_rm){
+  return reduce_matrix_lgl(sp_mat, na_rm, [value, na_rm](auto values, auto row_indices, int number_of_zeros) -> int{
     if(na_rm && value == 0.0){
       return number_of_zeros > 0;
     }else if(! na_rm && value == 0.0){
@@ -632,13 +988,13 @@ LogicalVector dgCMatrix_colAnys(S4 matrix, double value, bool na_rm){
         }
       }
     }else if(na_rm){
-      return std::any_of(values.begin(), values.end(),  [value](const double d) -> bool{
+      return std::any_of(values.begin(), values.end(),  [value](auto d) -> bool{
         return d == value;
       });
     }else{
       // !na_rm and value != 0
       bool any_na = is_any_na(values);
-      bool found_value = std::any_of(values.begin(), values.end(),  [value](const double d) -> bool{
+      bool found_value = std::any_of(values.begin(), values.end(),  [value](auto d) -> bool{
         return d == value;
       });
       if(any_na){
@@ -654,13 +1010,26 @@ LogicalVector dgCMatrix_colAnys(S4 matrix, double value, bool na_rm){
   });
 }
 
-
+// [[Rcpp::export]]
+LogicalVector dgCMatrix_colAnys(S4 matrix, double value, bool na_rm, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return dispatch_sparse_view(matrix, rows, cols, [value, na_rm](const auto& sp_mat) -> LogicalVector {
+    return colAnys_impl(sp_mat, value, na_rm);
+  });
+}
 
 // [[Rcpp::export]]
-LogicalVector dgCMatrix_colAlls(S4 matrix, double value, bool na_rm){
-  Rcpp::IntegerVector dim = matrix.slot("Dim");
-  R_len_t nrows = dim[0];
-  return reduce_matrix_lgl(matrix, na_rm, [value, na_rm, nrows](auto values, auto row_indices, int number_of_zeros) -> int{
+LogicalVector dgCMatrix_rowAnys(S4 matrix, double value, bool na_rm, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return reduce_row_tiles(wrap_dgCMatrix(matrix, rows, cols), [&](const dgCMatrixView& tile, R_len_t, R_len_t) {
+    return colAnys_impl(tile, value, na_rm);
+  });
+}
+
+
+
+template<int RTYPE>
+LogicalVector colAlls_impl(const SparseMatrixView<RTYPE>& sp_mat, double value, bool na_rm){
+  R_len_t nrows = sp_mat.nrow;
+  return reduce_matrix_lgl(sp_mat, na_rm, [value, na_rm, nrows](auto values, auto row_indices, int number_of_zeros) -> int{
     if(value == 0.0){
       if(na_rm){
         return values.is_empty();
@@ -681,12 +1050,12 @@ LogicalVector dgCMatrix_colAlls(S4 matrix, double value, bool na_rm){
         return false;
       }
       if(na_rm){
-        return std::all_of(values.begin(), values.end(), [value](const double d) -> bool {
+        return std::all_of(values.begin(), values.end(), [value](auto d) -> bool {
           return d == value;
         });
       }else{
-        bool all_equal_or_na = std::all_of(values.begin(), values.end(), [value](const double d) -> bool {
-          return d == value || NumericVector::is_na(d);
+        bool all_equal_or_na = std::all_of(values.begin(), values.end(), [value](auto d) -> bool {
+          return d == value || is_na_value(d);
         });
         bool any_na = is_any_na(values);
         if(! all_equal_or_na){
@@ -702,30 +1071,139 @@ LogicalVector dgCMatrix_colAlls(S4 matrix, double value, bool na_rm){
   });
 }
 
+// [[Rcpp::export]]
+LogicalVector dgCMatrix_colAlls(S4 matrix, double value, bool na_rm, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return dispatch_sparse_view(matrix, rows, cols, [value, na_rm](const auto& sp_mat) -> LogicalVector {
+    return colAlls_impl(sp_mat, value, na_rm);
+  });
+}
+
+// [[Rcpp::export]]
+LogicalVector dgCMatrix_rowAlls(S4 matrix, double value, bool na_rm, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return reduce_row_tiles(wrap_dgCMatrix(matrix, rows, cols), [&](const dgCMatrixView& tile, R_len_t, R_len_t) {
+    return colAlls_impl(tile, value, na_rm);
+  });
+}
+
 
 /*---------------Return matrix functions-----------------*/
 
 
 // [[Rcpp::export]]
-NumericMatrix dgCMatrix_colQuantiles(S4 matrix, NumericVector probs, bool na_rm){
-  return reduce_matrix_num_matrix(matrix, na_rm, probs.size(), true, [na_rm, probs](auto values, auto row_indices, int number_of_zeros) -> std::vector<double> {
-    if(! na_rm){
-      bool any_na = is_any_na(values);
-      if(any_na){
-        std::vector<double> result(probs.size(), NA_REAL);
-        return result;
-      }
+double quantile_sparse(NumericVector values, int number_of_zeros, double prob){
+  ColumnSpan<double> span(values.begin(), values.size());
+  return quantile_sparse_impl(span, number_of_zeros, prob);
+}
+
+NumericMatrix colQuantiles_impl(const dgCMatrixView& sp_mat, NumericVector probs, bool na_rm){
+  return reduce_matrix_num_matrix(sp_mat, na_rm, probs.size(), true, [probs](auto values, auto row_indices, int number_of_zeros, OutputSpan<double> out) -> void {
+    if(is_any_na(values)){
+      out.fill(NA_REAL);
+      return;
     }
     if(values.size() + number_of_zeros == 0){
-      std::vector<double> result(probs.size(), NA_REAL);
-      return result;
+      out.fill(NA_REAL);
+      return;
     }
-    std::vector<double> result;
-    result.reserve(probs.size());
-    std::transform(probs.begin(), probs.end(), back_inserter(result), [values, number_of_zeros](double prob) -> double{
-      return quantile_sparse_impl(values, number_of_zeros, prob);
+    if(probs.size() == 1){
+      out[0] = quantile_sparse_select(values, number_of_zeros, probs[0]);
+      return;
+    }
+    // Sort (at most) once, answer all probs from the same ordering
+    auto sorted_column = make_sorted_sparse_column(values, number_of_zeros);
+    for(R_len_t i = 0; i < probs.size(); ++i){
+      out[i] = sorted_column.quantile(probs[i]);
+    }
+  });
+}
+
+// [[Rcpp::export]]
+NumericMatrix dgCMatrix_colQuantiles(S4 matrix, NumericVector probs, bool na_rm, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return colQuantiles_impl(wrap_dgCMatrix(matrix, rows, cols), probs, na_rm);
+}
+
+// [[Rcpp::export]]
+NumericMatrix dgCMatrix_rowQuantiles(S4 matrix, NumericVector probs, bool na_rm, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return reduce_row_tiles(wrap_dgCMatrix(matrix, rows, cols), [&](const dgCMatrixView& tile, R_len_t, R_len_t) {
+    return colQuantiles_impl(tile, probs, na_rm);
+  });
+}
+
+// Approximate quantiles from a t-digest per column (see quantile_sketch.h),
+// the values are read once and only the sketch is sorted.
+// [[Rcpp::export]]
+NumericMatrix dgCMatrix_colQuantilesApprox(S4 matrix, NumericVector probs, bool na_rm, double compression, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  if(! (compression >= 10)){
+    throw std::range_error("The compression of the quantile sketch must be at least 10");
+  }
+  for(double prob : probs){
+    if(! (prob >= 0 && prob <= 1)){
+      throw std::range_error("prob must be between 0 and 1");
+    }
+  }
+  return reduce_matrix_num_matrix(wrap_dgCMatrix(matrix, rows, cols), na_rm, probs.size(), true, [probs, compression](auto values, auto row_indices, int number_of_zeros, OutputSpan<double> out) -> void {
+    SparseQuantileSketch sketch(compression);
+    for(double v : values){
+      if(is_na_value(v)){
+        out.fill(NA_REAL);
+        return;
+      }
+      sketch.add(v);
+    }
+    sketch.flush();
+    for(R_len_t i = 0; i < probs.size(); ++i){
+      out[i] = sketch.quantile(probs[i], number_of_zeros);
+    }
+  });
+}
+
+
+// The k largest (smallest) elements of each column and their rows, as two
+// k x ncol matrices (ncol x k with transpose = TRUE). k is capped at nrow,
+// columns with fewer than k elements that are not NA are padded with NA.
+List colTopK_impl(const dgCMatrixView& sp_mat, int k, bool decreasing, bool transpose){
+  if(k < 0){
+    throw std::range_error("k must not be negative");
+  }
+  R_len_t nrow = sp_mat.nrow;
+  R_len_t ncol = sp_mat.ncol;
+  R_len_t n_res = std::min<R_len_t>(k, nrow);
+  NumericMatrix values = transpose ? NumericMatrix(ncol, n_res) : NumericMatrix(n_res, ncol);
+  IntegerMatrix indices = transpose ? IntegerMatrix(ncol, n_res) : IntegerMatrix(n_res, ncol);
+  double* values_ptr = values.begin();
+  int* indices_ptr = indices.begin();
+  ColumnView cv(&sp_mat);
+  auto run = [&](auto decreasing_tag) -> void {
+    parallel_for_columns(sp_mat, get_n_threads(), [&cv, values_ptr, indices_ptr, nrow, ncol, n_res, transpose](R_len_t col_idx) -> void {
+      auto col = cv[col_idx];
+      R_xlen_t offset = transpose ? col_idx : (R_xlen_t) col_idx * n_res;
+      R_xlen_t stride = transpose ? ncol : 1;
+      OutputSpan<double> out_values(values_ptr + offset, n_res, stride);
+      OutputSpan<int> out_indices(indices_ptr + offset, n_res, stride);
+      R_len_t n = top_k_sparse<decltype(decreasing_tag)::value>(col.values, col.row_indices, nrow, n_res, out_values, out_indices);
+      for(; n < n_res; ++n){
+        out_values[n] = NA_REAL;
+        out_indices[n] = NA_INTEGER;
+      }
     });
-    return result;
+  };
+  if(decreasing){
+    run(std::true_type());
+  }else{
+    run(std::false_type());
+  }
+  return List::create(Named("values") = values, Named("indices") = indices);
+}
+
+// [[Rcpp::export]]
+List dgCMatrix_colTopK(S4 matrix, int k, bool decreasing, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return colTopK_impl(wrap_dgCMatrix(matrix, rows, cols), k, decreasing, false);
+}
+
+// [[Rcpp::export]]
+List dgCMatrix_rowTopK(S4 matrix, int k, bool decreasing, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return reduce_row_tiles(wrap_dgCMatrix(matrix, rows, cols), [&](const dgCMatrixView& tile, R_len_t, R_len_t) {
+    return colTopK_impl(tile, k, decreasing, true);
   });
 }
 
@@ -760,8 +1238,8 @@ IntegerMatrix dgCMatrix_colTabulate(S4 matrix, NumericVector sorted_unique_value
     }
   }
   return reduce_matrix_int_matrix_with_na(matrix, lookup_map.size() + count_nas + count_zeros, true,
-      [&lookup_map, count_zeros, zero_indx, count_nas, na_indx](auto values, auto row_indices, int number_of_zeros) -> std::vector<int> {
-    std::vector<int> result(lookup_map.size() + count_nas + count_zeros, 0);
+      [&lookup_map, count_zeros, zero_indx, count_nas, na_indx](auto values, auto row_indices, int number_of_zeros, OutputSpan<int> result) -> void {
+    result.fill(0);
     int na_count = 0;
     int zero_count = 0;
     auto lookup_map_end = lookup_map.end();
@@ -783,7 +1261,6 @@ IntegerMatrix dgCMatrix_colTabulate(S4 matrix, NumericVector sorted_unique_value
     if(count_nas){
       result[na_indx] = na_count;
     }
-    return result;
   });
 }
 
@@ -791,163 +1268,489 @@ IntegerMatrix dgCMatrix_colTabulate(S4 matrix, NumericVector sorted_unique_value
 
 /*---------------Cumulative functions-----------------*/
 
+// The cumulative functions are step functions of the row: between two stored
+// elements, the accumulator only changes at the first implicit zero.
+// scan_cumulative() updates the accumulator with Op::value(acc, v) for every
+// stored element and with Op::zero(acc) once per run of implicit zeros (so
+// Op::zero must be idempotent), and calls emit(row_begin, row_end, acc) for
+// every run of rows that share the same result.
+template<typename Op, typename VT, typename IT, typename Emit>
+void scan_cumulative(VT values, IT row_indices, R_len_t nrows, Emit emit){
+  typename Op::acc_type acc = Op::init();
+  R_len_t next_row = 0;
+  auto row_it = row_indices.begin();
+  auto row_end = row_indices.end();
+  auto val_it = values.begin();
+  for(; row_it != row_end; ++row_it, ++val_it){
+    R_len_t row = *row_it;
+    if(row > next_row){
+      acc = Op::zero(acc);
+      emit(next_row, row, acc);
+    }
+    acc = Op::value(acc, *val_it);
+    emit(row, row + 1, acc);
+    next_row = row + 1;
+  }
+  if(next_row < nrows){
+    acc = Op::zero(acc);
+    emit(next_row, nrows, acc);
+  }
+}
 
-// [[Rcpp::export]]
-NumericMatrix dgCMatrix_colCumsums(S4 matrix){
-  Rcpp::IntegerVector dim = matrix.slot("Dim");
-  R_len_t nrows = dim[0];
-  return reduce_matrix_num_matrix_with_na(matrix, nrows, false, [nrows](auto values, auto row_indices, int number_of_zeros) -> std::vector<double>{
-    std::vector<double> result(nrows);
-    double acc = 0;
-    auto row_it = row_indices.begin();
-    auto row_end = row_indices.end();
-    auto val_it = values.begin();
-    auto res_it = result.begin();
-    for(int i = 0; i < nrows; ++i, ++res_it){
-      if(row_it != row_end && i == *row_it){
-        acc += *val_it;
-        ++row_it;
-        ++val_it;
+struct CumsumOp {
+  typedef double acc_type;
+  static double init(){ return 0.0; }
+  static double value(double acc, double v){ return acc + v; }
+  static double zero(double acc){ return acc; }
+};
+
+struct CumprodOp {
+  typedef LDOUBLE acc_type;
+  static LDOUBLE init(){ return 1.0; }
+  static LDOUBLE value(LDOUBLE acc, double v){ return acc * v; }
+  // Keeps NaN's (and turns Inf into NaN)
+  static LDOUBLE zero(LDOUBLE acc){ return 0 * acc; }
+};
+
+// Once the accumulator is NA, it stays NA
+struct CumminOp {
+  typedef double acc_type;
+  static double init(){ return R_PosInf; }
+  static double value(double acc, double v){ return NumericVector::is_na(acc) ? acc : std::min(v, acc); }
+  static double zero(double acc){ return NumericVector::is_na(acc) ? acc : std::min(0.0, acc); }
+};
+
+struct CummaxOp {
+  typedef double acc_type;
+  static double init(){ return R_NegInf; }
+  static double value(double acc, double v){ return NumericVector::is_na(acc) ? acc : std::max(v, acc); }
+  static double zero(double acc){ return NumericVector::is_na(acc) ? acc : std::max(0.0, acc); }
+};
+
+
+template<typename Op>
+NumericMatrix colCumulative_impl(const dgCMatrixView& sp_mat, bool transpose){
+  R_len_t nrows = sp_mat.nrow;
+  return reduce_matrix_num_matrix_with_na(sp_mat, nrows, transpose, [nrows](auto values, auto row_indices, int number_of_zeros, OutputSpan<double> result) -> void {
+    scan_cumulative<Op>(values, row_indices, nrows, [&result](R_len_t row_begin, R_len_t row_end, typename Op::acc_type acc) -> void {
+      for(R_len_t row = row_begin; row < row_end; ++row){
+        result[row] = acc;
       }
-      *res_it = acc;
-    }
-    return result;
+    });
+  });
+}
+
+// Only the rows where the cumulative result is not zero are stored. For
+// cumprods, that is at most up to the first implicit zero.
+template<typename Op>
+S4 colCumulative_sparse_impl(const dgCMatrixView& sp_mat, bool transpose){
+  R_len_t nrows = sp_mat.nrow;
+  return reduce_matrix_sparse_matrix_with_na(sp_mat, nrows, transpose, [nrows](auto values, auto row_indices, int number_of_zeros, SparseOutput& out) -> void {
+    scan_cumulative<Op>(values, row_indices, nrows, [&out](R_len_t row_begin, R_len_t row_end, typename Op::acc_type acc) -> void {
+      if(acc != 0){
+        for(R_len_t row = row_begin; row < row_end; ++row){
+          out.push(row, acc);
+        }
+      }
+    });
   });
 }
 
+S4 colCumulative_sparse_dispatch(const dgCMatrixView& sp_mat, std::string fun, bool transpose){
+  if(fun == "cumsum"){
+    return colCumulative_sparse_impl<CumsumOp>(sp_mat, transpose);
+  }else if(fun == "cumprod"){
+    return colCumulative_sparse_impl<CumprodOp>(sp_mat, transpose);
+  }else if(fun == "cummin"){
+    return colCumulative_sparse_impl<CumminOp>(sp_mat, transpose);
+  }else if(fun == "cummax"){
+    return colCumulative_sparse_impl<CummaxOp>(sp_mat, transpose);
+  }else{
+    throw std::runtime_error("Unknown argument to fun: " + fun + ". Can only handle 'cumsum', 'cumprod', 'cummin', and 'cummax'.");
+  }
+}
 
 
 // [[Rcpp::export]]
-NumericMatrix dgCMatrix_colCumprods(S4 matrix){
-  Rcpp::IntegerVector dim = matrix.slot("Dim");
-  R_len_t nrows = dim[0];
-  return reduce_matrix_num_matrix_with_na(matrix, nrows, false, [nrows](auto values, auto row_indices, int number_of_zeros) -> std::vector<double>{
-    std::vector<double> result(nrows);
-    LDOUBLE acc = 1;
-    auto row_it = row_indices.begin();
-    auto row_end = row_indices.end();
-    auto val_it = values.begin();
-    auto res_it = result.begin();
-    for(int i = 0; i < nrows; ++i, ++res_it){
-      if(row_it != row_end && i == *row_it){
-        acc *= *val_it;
-        ++row_it;
-        ++val_it;
-      }else{
-        acc = 0 * acc;
-      }
-      *res_it = acc;
-    }
-    return result;
+NumericMatrix dgCMatrix_colCumsums(S4 matrix, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return colCumulative_impl<CumsumOp>(wrap_dgCMatrix(matrix, rows, cols), false);
+}
+
+// [[Rcpp::export]]
+NumericMatrix dgCMatrix_rowCumsums(S4 matrix, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return reduce_row_tiles(wrap_dgCMatrix(matrix, rows, cols), [&](const dgCMatrixView& tile, R_len_t, R_len_t) {
+    return colCumulative_impl<CumsumOp>(tile, true);
   });
 }
 
+// [[Rcpp::export]]
+NumericMatrix dgCMatrix_colCumprods(S4 matrix, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return colCumulative_impl<CumprodOp>(wrap_dgCMatrix(matrix, rows, cols), false);
+}
+
+// [[Rcpp::export]]
+NumericMatrix dgCMatrix_rowCumprods(S4 matrix, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return reduce_row_tiles(wrap_dgCMatrix(matrix, rows, cols), [&](const dgCMatrixView& tile, R_len_t, R_len_t) {
+    return colCumulative_impl<CumprodOp>(tile, true);
+  });
+}
+
+// [[Rcpp::export]]
+NumericMatrix dgCMatrix_colCummins(S4 matrix, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return colCumulative_impl<CumminOp>(wrap_dgCMatrix(matrix, rows, cols), false);
+}
+
+// [[Rcpp::export]]
+NumericMatrix dgCMatrix_rowCummins(S4 matrix, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return reduce_row_tiles(wrap_dgCMatrix(matrix, rows, cols), [&](const dgCMatrixView& tile, R_len_t, R_len_t) {
+    return colCumulative_impl<CumminOp>(tile, true);
+  });
+}
 
 // [[Rcpp::export]]
-NumericMatrix dgCMatrix_colCummins(S4 matrix){
-  Rcpp::IntegerVector dim = matrix.slot("Dim");
-  R_len_t nrows = dim[0];
-  return reduce_matrix_num_matrix_with_na(matrix, nrows, false, [nrows](auto values, auto row_indices, int number_of_zeros) -> std::vector<double>{
-    std::vector<double> result(nrows);
-    if(nrows == 0){
-      // Without this escape hatch, the following code would segfault
-      return result;
+NumericMatrix dgCMatrix_colCummaxs(S4 matrix, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return colCumulative_impl<CummaxOp>(wrap_dgCMatrix(matrix, rows, cols), false);
+}
+
+// [[Rcpp::export]]
+NumericMatrix dgCMatrix_rowCummaxs(S4 matrix, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return reduce_row_tiles(wrap_dgCMatrix(matrix, rows, cols), [&](const dgCMatrixView& tile, R_len_t, R_len_t) {
+    return colCumulative_impl<CummaxOp>(tile, true);
+  });
+}
+
+// The cumulative function fun ("cumsum", "cumprod", "cummin", or "cummax") as a dgCMatrix
+// [[Rcpp::export]]
+S4 dgCMatrix_colCumulative_sparse(S4 matrix, std::string fun, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return colCumulative_sparse_dispatch(wrap_dgCMatrix(matrix, rows, cols), fun, false);
+}
+
+// [[Rcpp::export]]
+S4 dgCMatrix_rowCumulative_sparse(S4 matrix, std::string fun, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return reduce_row_tiles(wrap_dgCMatrix(matrix, rows, cols), [&](const dgCMatrixView& tile, R_len_t, R_len_t) {
+    return colCumulative_sparse_dispatch(tile, fun, true);
+  });
+}
+
+
+
+/*---------------Difference functions-----------------*/
+
+// The lagged differences x[i + lag] - x[i] (i = 0, ..., n - lag - 1) of a
+// sparse vector of length n with the (sorted) rows and values. Only the
+// positions r and r - lag of the stored rows r can be non-zero, so the two
+// sorted sequences are merged. Appends the non-zero differences to out_rows
+// and out_values.
+template<typename VT, typename IT>
+void sparse_lagged_diff(const VT& values, const IT& rows, R_len_t n, R_len_t lag,
+                        std::vector<int>& out_rows, std::vector<double>& out_values){
+  R_len_t n_out = n - lag;
+  size_t nnz = values.size();
+  size_t minus = 0; // element that enters as - x[i], at position rows[minus]
+  size_t plus = 0;  // element that enters as + x[i + lag], at position rows[plus] - lag
+  while(plus < nnz && rows[plus] < lag){
+    ++plus;
+  }
+  while(true){
+    R_len_t pos_minus = minus < nnz ? rows[minus] : n_out;
+    R_len_t pos_plus = plus < nnz ? rows[plus] - lag : n_out;
+    R_len_t pos = std::min(pos_minus, pos_plus);
+    if(pos >= n_out){
+      break;
     }
-    auto row_it = row_indices.begin();
-    auto row_end = row_indices.end();
-    auto val_it = values.begin();
-    auto res_it = result.begin();
-    int i = 0;
-    double acc = 0.0;
-    if(row_it != row_end && i == *row_it){
-      acc = *val_it;
-      ++row_it;
-      ++val_it;
-    }else{
-      acc = 0.0;
-    }
-    *res_it = acc;
-    ++res_it;
-    for(i = 1; i < nrows; ++i, ++res_it){
-      if(NumericVector::is_na(acc)){
-        // Do nothing it will always stay NA
-      }else if(row_it != row_end && i == *row_it){
-        acc = std::min(*val_it, acc);
-        ++row_it;
-        ++val_it;
-      }else{
-        acc = std::min(0.0, acc);
-      }
-      *res_it = acc;
+    double upper = 0.0;
+    double lower = 0.0;
+    if(pos_plus == pos){
+      upper = values[plus];
+      ++plus;
     }
-    return result;
+    if(pos_minus == pos){
+      lower = values[minus];
+      ++minus;
+    }
+    double diff = upper - lower;
+    if(diff != 0){
+      out_rows.push_back(pos);
+      out_values.push_back(diff);
+    }
+  }
+}
+
+// Applies sparse_lagged_diff() differences times (differences = 0 copies the
+// input). The intermediate results are kept in thread_local buffers. Returns
+// the length of the result.
+template<typename VT, typename IT>
+R_len_t sparse_diff(const VT& values, const IT& rows, R_len_t n, R_len_t lag, int differences,
+                    std::vector<int>& out_rows, std::vector<double>& out_values){
+  out_rows.clear();
+  out_values.clear();
+  if(differences == 0){
+    out_rows.assign(rows.begin(), rows.end());
+    out_values.assign(values.begin(), values.end());
+    return n;
+  }
+  if(n - lag <= 0){
+    return 0;
+  }
+  sparse_lagged_diff(values, rows, n, lag, out_rows, out_values);
+  n -= lag;
+  thread_local std::vector<int> tmp_rows;
+  thread_local std::vector<double> tmp_values;
+  for(int d = 1; d < differences; ++d){
+    if(n - lag <= 0){
+      out_rows.clear();
+      out_values.clear();
+      return 0;
+    }
+    tmp_rows.swap(out_rows);
+    tmp_values.swap(out_values);
+    out_rows.clear();
+    out_values.clear();
+    sparse_lagged_diff(tmp_values, tmp_rows, n, lag, out_rows, out_values);
+    n -= lag;
+  }
+  return n;
+}
+
+S4 colDiffs_sparse_impl(const dgCMatrixView& sp_mat, int lag, int differences, bool transpose){
+  if(lag < 1 || differences < 0){
+    throw std::range_error("lag must be positive and differences must not be negative");
+  }
+  R_len_t nrows = sp_mat.nrow;
+  R_len_t n_res_rows = (R_len_t) std::max<double>((double) nrows - (double) lag * differences, 0);
+  return reduce_matrix_sparse_matrix_with_na(sp_mat, n_res_rows, transpose, [nrows, lag, differences](auto values, auto row_indices, int number_of_zeros, SparseOutput& out) -> void {
+    thread_local std::vector<int> diff_rows;
+    thread_local std::vector<double> diff_values;
+    sparse_diff(values, row_indices, nrows, lag, differences, diff_rows, diff_values);
+    for(size_t k = 0; k < diff_rows.size(); ++k){
+      out.push(diff_rows[k], diff_values[k]);
+    }
+  });
+}
+
+NumericMatrix colDiffs_impl(const dgCMatrixView& sp_mat, int lag, int differences, bool transpose){
+  if(lag < 1 || differences < 0){
+    throw std::range_error("lag must be positive and differences must not be negative");
+  }
+  R_len_t nrows = sp_mat.nrow;
+  R_len_t n_res_rows = (R_len_t) std::max<double>((double) nrows - (double) lag * differences, 0);
+  return reduce_matrix_num_matrix_with_na(sp_mat, n_res_rows, transpose, [nrows, lag, differences](auto values, auto row_indices, int number_of_zeros, OutputSpan<double> out) -> void {
+    thread_local std::vector<int> diff_rows;
+    thread_local std::vector<double> diff_values;
+    sparse_diff(values, row_indices, nrows, lag, differences, diff_rows, diff_values);
+    out.fill(0.0);
+    for(size_t k = 0; k < diff_rows.size(); ++k){
+      out[diff_rows[k]] = diff_values[k];
+    }
+  });
+}
+
+// [[Rcpp::export]]
+NumericMatrix dgCMatrix_colDiffs(S4 matrix, int lag, int differences, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return colDiffs_impl(wrap_dgCMatrix(matrix, rows, cols), lag, differences, false);
+}
+
+// [[Rcpp::export]]
+NumericMatrix dgCMatrix_rowDiffs(S4 matrix, int lag, int differences, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return reduce_row_tiles(wrap_dgCMatrix(matrix, rows, cols), [&](const dgCMatrixView& tile, R_len_t, R_len_t) {
+    return colDiffs_impl(tile, lag, differences, true);
   });
 }
 
+// [[Rcpp::export]]
+S4 dgCMatrix_colDiffs_sparse(S4 matrix, int lag, int differences, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return colDiffs_sparse_impl(wrap_dgCMatrix(matrix, rows, cols), lag, differences, false);
+}
 
 // [[Rcpp::export]]
-NumericMatrix dgCMatrix_colCummaxs(S4 matrix){
-  Rcpp::IntegerVector dim = matrix.slot("Dim");
-  R_len_t nrows = dim[0];
-  return reduce_matrix_num_matrix_with_na(matrix, nrows, false, [nrows](auto values, auto row_indices, int number_of_zeros) -> std::vector<double>{
-    std::vector<double> result(nrows);
-    if(nrows == 0){
-      // Without this escape hatch, the following code would segfault
-      return result;
+S4 dgCMatrix_rowDiffs_sparse(S4 matrix, int lag, int differences, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return reduce_row_tiles(wrap_dgCMatrix(matrix, rows, cols), [&](const dgCMatrixView& tile, R_len_t, R_len_t) {
+    return colDiffs_sparse_impl(tile, lag, differences, true);
+  });
+}
+
+
+// The variance, standard deviation, MAD, or IQR of diff(x, differences = diff)
+// for each column x, as in matrixStats::varDiff() (etc.) but without the
+// correction for the amplification by the differences, which is applied in R.
+// With na_rm, the NA's are removed before the differences are calculated,
+// so the rows behind them move up. The differences stay sparse, the
+// statistics treat their implicit zeros as a single block.
+NumericVector colDiffStats_impl(const dgCMatrixView& sp_mat, std::string stat, bool na_rm, int diff, double constant){
+  if(diff < 0){
+    throw std::range_error("diff must not be negative");
+  }
+  if(stat != "var" && stat != "sd" && stat != "mad" && stat != "iqr"){
+    throw std::runtime_error("Unknown argument to stat: " + stat + ". Can only handle 'var', 'sd', 'mad', and 'iqr'.");
+  }
+  R_len_t nrows = sp_mat.nrow;
+  return reduce_matrix_double(sp_mat, false, [nrows, stat, na_rm, diff, constant](auto values, auto row_indices, int number_of_zeros) -> double{
+    thread_local std::vector<int> kept_rows;
+    thread_local std::vector<double> kept_values;
+    kept_rows.clear();
+    kept_values.clear();
+    R_len_t n_na = 0;
+    for(R_len_t k = 0; k < values.size(); ++k){
+      if(ISNAN(values[k])){
+        if(! na_rm){
+          return NA_REAL;
+        }
+        ++n_na;
+      }else{
+        kept_rows.push_back(row_indices[k] - n_na);
+        kept_values.push_back(values[k]);
+      }
     }
-    auto row_it = row_indices.begin();
-    auto row_end = row_indices.end();
-    auto val_it = values.begin();
-    auto res_it = result.begin();
-    int i = 0;
-    double acc = 0.0;
-    if(row_it != row_end && i == *row_it){
-      acc = *val_it;
-      ++row_it;
-      ++val_it;
+    R_len_t size = nrows - n_na;
+    if(size <= 1){
+      return NA_REAL;
+    }
+    thread_local std::vector<int> diff_rows;
+    thread_local std::vector<double> diff_values;
+    R_len_t n_diffs = sparse_diff(kept_values, kept_rows, size, 1, diff, diff_rows, diff_values);
+    ColumnSpan<double> diffs(diff_values.data(), diff_values.size());
+    R_len_t n_zeros = n_diffs - diffs.size();
+    if(std::any_of(diffs.begin(), diffs.end(), [](double d) -> bool { return ISNAN(d); })){
+      return NA_REAL;
+    }
+    if(stat == "var" || stat == "sd"){
+      if(n_diffs <= 1){
+        return NA_REAL;
+      }
+      double mean = sum_stable(diffs) / n_diffs;
+      double sigma2 = (n_zeros * mean * mean + simd_sum_squared_deviations(diffs.begin(), diffs.size(), mean)) / (n_diffs - 1);
+      return stat == "var" ? sigma2 : std::sqrt(sigma2);
+    }else if(stat == "mad"){
+      if(n_diffs == 0){
+        return NA_REAL;
+      }
+      if(n_zeros > diffs.size()){
+        return 0.0;
+      }
+      double med = quantile_sparse_select(diffs, n_zeros, 0.5);
+      if(ISNAN(med)){
+        return NA_REAL;
+      }
+      thread_local std::vector<double> deviations;
+      deviations.resize(diffs.size());
+      std::transform(diffs.begin(), diffs.end(), deviations.begin(), [med](double v) -> double {
+        return std::abs(v - med);
+      });
+      if(std::any_of(deviations.begin(), deviations.end(), [](double d) -> bool { return ISNAN(d); })){
+        return NA_REAL;
+      }
+      ColumnSpan<double> deviation_span(deviations.data(), deviations.size());
+      return median_with_atom(deviation_span, std::abs(med), n_zeros) * constant;
     }else{
-      acc = 0.0;
-    }
-    *res_it = acc;
-    ++res_it;
-    for(i = 1; i < nrows; ++i, ++res_it){
-      if(NumericVector::is_na(acc)){
-        // Do nothing it will always stay NA
-      }else if(row_it != row_end && i == *row_it){
-        acc = std::max(*val_it, acc);
-        ++row_it;
-        ++val_it;
-      }else{
-        acc = std::max(0.0, acc);
+      if(n_diffs == 0){
+        return NA_REAL;
       }
-      *res_it = acc;
+      return quantile_sparse_select(diffs, n_zeros, 0.75) - quantile_sparse_select(diffs, n_zeros, 0.25);
     }
-    return result;
+  });
+}
+
+// [[Rcpp::export]]
+NumericVector dgCMatrix_colDiffStats(S4 matrix, std::string stat, bool na_rm, int diff, double constant, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return colDiffStats_impl(wrap_dgCMatrix(matrix, rows, cols), stat, na_rm, diff, constant);
+}
+
+// [[Rcpp::export]]
+NumericVector dgCMatrix_rowDiffStats(S4 matrix, std::string stat, bool na_rm, int diff, double constant, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return reduce_row_tiles(wrap_dgCMatrix(matrix, rows, cols), [&](const dgCMatrixView& tile, R_len_t, R_len_t) {
+    return colDiffStats_impl(tile, stat, na_rm, diff, constant);
   });
 }
 
 
 /*------------------Ranking function------------------*/
 
+NumericMatrix colRanks_num_impl(const dgCMatrixView& sp_mat, std::string ties_method, std::string na_handling, bool transpose){
+  R_len_t nrows = sp_mat.nrow;
+  NumericMatrix result;
+  dispatch_rank_method(ties_method, na_handling, [&](auto ties_tag, auto na_tag) -> void {
+    result = reduce_matrix_num_matrix_with_na(sp_mat, nrows, transpose,
+        [](auto values, auto row_indices, int number_of_zeros, OutputSpan<double> out) -> void {
+      calculate_sparse_rank<decltype(ties_tag)::value, decltype(na_tag)::value>(values, row_indices, number_of_zeros, out);
+    });
+  });
+  return result;
+}
+
 // [[Rcpp::export]]
-NumericMatrix dgCMatrix_colRanks_num(S4 matrix, std::string ties_method, std::string na_handling, bool preserve_shape){
-  Rcpp::IntegerVector dim = matrix.slot("Dim");
-  R_len_t nrows = dim[0];
-  return reduce_matrix_num_matrix_with_na(matrix, nrows, !preserve_shape,
-      [na_handling, ties_method](VectorSubsetView<REALSXP> values, VectorSubsetView<INTSXP> row_indices, int number_of_zeros) -> std::vector<double>{
-    return calculate_sparse_rank<double>(values, row_indices, number_of_zeros, ties_method, na_handling);
+NumericMatrix dgCMatrix_colRanks_num(S4 matrix, std::string ties_method, std::string na_handling, bool preserve_shape, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return colRanks_num_impl(wrap_dgCMatrix(matrix, rows, cols), ties_method, na_handling, ! preserve_shape);
+}
+
+// [[Rcpp::export]]
+NumericMatrix dgCMatrix_rowRanks_num(S4 matrix, std::string ties_method, std::string na_handling, bool preserve_shape, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return reduce_row_tiles(wrap_dgCMatrix(matrix, rows, cols), [&](const dgCMatrixView& tile, R_len_t, R_len_t) {
+    return colRanks_num_impl(tile, ties_method, na_handling, preserve_shape);
+  }, ! preserve_shape);
+}
+
+
+IntegerMatrix colRanks_int_impl(const dgCMatrixView& sp_mat, std::string ties_method, std::string na_handling, bool transpose){
+  R_len_t nrows = sp_mat.nrow;
+  IntegerMatrix result;
+  dispatch_rank_method(ties_method, na_handling, [&](auto ties_tag, auto na_tag) -> void {
+    result = reduce_matrix_int_matrix_with_na(sp_mat, nrows, transpose,
+        [](auto values, auto row_indices, int number_of_zeros, OutputSpan<int> out) -> void {
+      calculate_sparse_rank<decltype(ties_tag)::value, decltype(na_tag)::value>(values, row_indices, number_of_zeros, out);
+    });
   });
+  return result;
 }
 
+// [[Rcpp::export]]
+IntegerMatrix dgCMatrix_colRanks_int(S4 matrix, std::string ties_method, std::string na_handling, bool preserve_shape, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return colRanks_int_impl(wrap_dgCMatrix(matrix, rows, cols), ties_method, na_handling, ! preserve_shape);
+}
 
 // [[Rcpp::export]]
-IntegerMatrix dgCMatrix_colRanks_int(S4 matrix, std::string ties_method, std::string na_handling, bool preserve_shape){
-  Rcpp::IntegerVector dim = matrix.slot("Dim");
-  R_len_t nrows = dim[0];
-  return reduce_matrix_int_matrix_with_na(matrix, nrows, !preserve_shape,
-    [na_handling, ties_method](VectorSubsetView<REALSXP> values, VectorSubsetView<INTSXP> row_indices, int number_of_zeros) -> std::vector<int>{
-      return calculate_sparse_rank<int>(values, row_indices, number_of_zeros, ties_method, na_handling);
+IntegerMatrix dgCMatrix_rowRanks_int(S4 matrix, std::string ties_method, std::string na_handling, bool preserve_shape, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return reduce_row_tiles(wrap_dgCMatrix(matrix, rows, cols), [&](const dgCMatrixView& tile, R_len_t, R_len_t) {
+    return colRanks_int_impl(tile, ties_method, na_handling, preserve_shape);
+  }, ! preserve_shape);
+}
+
+
+// The ranks in "rank-offset" form: the zeros of each column share one rank
+// (zero_ranks), and the dgCMatrix offsets stores rank - zero rank for the
+// other elements. The cost only depends on the number of stored values.
+List colRanks_sparse_impl(const dgCMatrixView& sp_mat, std::string ties_method, std::string na_handling, bool transpose){
+  R_len_t nrows = sp_mat.nrow;
+  NumericVector zero_ranks;
+  S4 offsets;
+  dispatch_rank_method(ties_method, na_handling, [&](auto ties_tag, auto na_tag) -> void {
+    zero_ranks = reduce_matrix_double(sp_mat, false, [](auto values, auto row_indices, int number_of_zeros) -> double {
+      return sparse_zero_rank<decltype(ties_tag)::value>(values, number_of_zeros);
+    });
+    offsets = reduce_matrix_sparse_matrix_with_na(sp_mat, nrows, transpose,
+        [](auto values, auto row_indices, int number_of_zeros, SparseOutput& out) -> void {
+      thread_local std::vector<double> ranks;
+      ranks.resize(values.size());
+      double zero_rank = rank_sparse_column<decltype(ties_tag)::value, decltype(na_tag)::value>(values, number_of_zeros, [](R_len_t k, double rank) -> void {
+        ranks[k] = rank;
+      });
+      for(R_len_t k = 0; k < values.size(); ++k){
+        out.push(row_indices[k], ranks[k] - zero_rank);
+      }
+    });
   });
+  return List::create(Named("offsets") = offsets, Named("zero_ranks") = zero_ranks);
+}
+
+// [[Rcpp::export]]
+List dgCMatrix_colRanks_sparse(S4 matrix, std::string ties_method, std::string na_handling, bool preserve_shape, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return colRanks_sparse_impl(wrap_dgCMatrix(matrix, rows, cols), ties_method, na_handling, ! preserve_shape);
+}
+
+// [[Rcpp::export]]
+List dgCMatrix_rowRanks_sparse(S4 matrix, std::string ties_method, std::string na_handling, bool preserve_shape, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return reduce_row_tiles(wrap_dgCMatrix(matrix, rows, cols), [&](const dgCMatrixView& tile, R_len_t, R_len_t) {
+    return colRanks_sparse_impl(tile, ties_method, na_handling, preserve_shape);
+  }, ! preserve_shape);
 }
 
 
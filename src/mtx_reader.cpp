@@ -0,0 +1,362 @@
+#include <Rcpp.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+#include "summary_stats.h"
+#include "parallel.h"
+
+using namespace Rcpp;
+
+
+
+// Summary statistics of the rows and columns of a MatrixMarket file
+// (coordinate format), computed while the file is read. Nothing of the size
+// of the matrix is kept in memory, only a RowMomentAccumulator for the rows
+// and one for the columns (O(nrow + ncol)).
+// The work is pipelined:
+//  * A background thread reads the next chunk of the file (ChunkReader),
+//    while the current chunk is processed.
+//  * The lines of a chunk are parsed into (row, col, value) triplets on
+//    several threads (each thread gets a contiguous range of lines).
+//  * The triplets are added to the row and the column accumulators, the two
+//    margins on different threads. The values are always added in the
+//    order of the file, so the results do not depend on the number of
+//    threads or the chunk size.
+
+
+struct MtxHeader {
+  R_len_t nrow = 0;
+  R_len_t ncol = 0;
+  R_xlen_t n_entries = 0;
+  bool pattern = false;
+  // 0: general, 1: symmetric, -1: skew-symmetric
+  int symmetry = 0;
+};
+
+
+static bool read_line(FILE* file, std::string& line){
+  line.clear();
+  int c;
+  while((c = std::fgetc(file)) != EOF){
+    if(c == '\n'){
+      return true;
+    }
+    line.push_back((char) c);
+  }
+  return ! line.empty();
+}
+
+static std::string to_lower(std::string s){
+  for(char& c : s){
+    c = (char) std::tolower((unsigned char) c);
+  }
+  return s;
+}
+
+
+// Parses the banner, the comments, and the size line. Afterwards, file is
+// positioned at the first entry.
+static MtxHeader read_mtx_header(FILE* file){
+  std::string line;
+  if(! read_line(file, line)){
+    throw std::runtime_error("The file is empty");
+  }
+  char banner[64], object[64], format[64], field[64], symmetry[64];
+  if(std::sscanf(line.c_str(), "%63s %63s %63s %63s %63s", banner, object, format, field, symmetry) != 5 ||
+     std::string(banner) != "%%MatrixMarket"){
+    throw std::runtime_error("The file does not start with a MatrixMarket banner: " + line);
+  }
+  if(to_lower(object) != "matrix"){
+    throw std::runtime_error("Can only read a MatrixMarket matrix, not a " + std::string(object));
+  }
+  if(to_lower(format) != "coordinate"){
+    throw std::runtime_error("Can only read the coordinate format of MatrixMarket, not " + std::string(format));
+  }
+  MtxHeader header;
+  std::string field_str = to_lower(field);
+  if(field_str == "pattern"){
+    header.pattern = true;
+  }else if(field_str != "real" && field_str != "double" && field_str != "integer"){
+    throw std::runtime_error("Can only read real, integer, and pattern MatrixMarket files, not " + std::string(field));
+  }
+  std::string symmetry_str = to_lower(symmetry);
+  if(symmetry_str == "symmetric"){
+    header.symmetry = 1;
+  }else if(symmetry_str == "skew-symmetric"){
+    header.symmetry = -1;
+  }else if(symmetry_str != "general"){
+    throw std::runtime_error("Can only read general, symmetric, and skew-symmetric MatrixMarket files, not " + std::string(symmetry));
+  }
+  // Skip the comments
+  do{
+    if(! read_line(file, line)){
+      throw std::runtime_error("The MatrixMarket file has no size line");
+    }
+  }while(line.empty() || line[0] == '%' || line.find_first_not_of(" \t\r") == std::string::npos);
+  long long nrow, ncol, n_entries;
+  if(std::sscanf(line.c_str(), "%lld %lld %lld", &nrow, &ncol, &n_entries) != 3 ||
+     nrow < 0 || ncol < 0 || n_entries < 0){
+    throw std::runtime_error("Cannot parse the size line of the MatrixMarket file: " + line);
+  }
+  if(nrow > std::numeric_limits<int>::max() || ncol > std::numeric_limits<int>::max()){
+    throw std::range_error("The matrix has more rows or columns than R supports");
+  }
+  if(header.symmetry != 0 && nrow != ncol){
+    throw std::runtime_error("A symmetric MatrixMarket matrix must be square");
+  }
+  header.nrow = (R_len_t) nrow;
+  header.ncol = (R_len_t) ncol;
+  header.n_entries = (R_xlen_t) n_entries;
+  return header;
+}
+
+
+// Reads a file in chunks of (at most) chunk_size bytes. The next chunk is
+// read on a background thread while the caller processes the current one.
+// next() only returns complete lines, the rest of a chunk is carried over.
+class ChunkReader {
+  FILE* file;
+  size_t chunk_size;
+  std::future<std::vector<char> > pending;
+  std::vector<char> carry;
+
+  std::vector<char> read_block(){
+    std::vector<char> block(chunk_size);
+    size_t n = std::fread(block.data(), 1, chunk_size, file);
+    if(n < chunk_size && std::ferror(file)){
+      throw std::runtime_error("Error while reading the MatrixMarket file");
+    }
+    block.resize(n);
+    return block;
+  }
+
+public:
+  ChunkReader(FILE* file_, size_t chunk_size_): file(file_), chunk_size(std::max<size_t>(chunk_size_, 1)) {
+    pending = std::async(std::launch::async, [this]() { return read_block(); });
+  }
+
+  ~ChunkReader(){
+    if(pending.valid()){
+      pending.wait();
+    }
+  }
+
+  // Fills chunk with the next complete lines, each terminated by '\n' (also
+  // the last line of the file). Returns false at the end of the file.
+  bool next(std::vector<char>& chunk){
+    if(! pending.valid()){
+      return false;
+    }
+    std::vector<char> block = pending.get();
+    bool at_end = block.empty();
+    if(! at_end){
+      pending = std::async(std::launch::async, [this]() { return read_block(); });
+    }
+    chunk.swap(carry);
+    chunk.insert(chunk.end(), block.begin(), block.end());
+    carry.clear();
+    if(at_end){
+      if(! chunk.empty() && chunk.back() != '\n'){
+        chunk.push_back('\n');
+      }
+      return ! chunk.empty();
+    }
+    auto last_newline = std::find(chunk.rbegin(), chunk.rend(), '\n');
+    size_t complete = chunk.rend() - last_newline;
+    carry.assign(chunk.begin() + complete, chunk.end());
+    chunk.resize(complete);
+    return true;
+  }
+};
+
+
+struct MtxEntries {
+  std::vector<int> rows;
+  std::vector<int> cols;
+  std::vector<double> values;
+
+  void clear(){
+    rows.clear();
+    cols.clear();
+    values.clear();
+  }
+};
+
+
+static inline const char* skip_blanks(const char* p){
+  while(*p == ' ' || *p == '\t' || *p == '\r'){
+    ++p;
+  }
+  return p;
+}
+
+// A 1-based index between 1 and n, converted to 0-based. Returns -1 if the
+// text at p is not a valid index.
+static inline int parse_index(const char*& p, R_len_t n){
+  p = skip_blanks(p);
+  long long value = 0;
+  const char* start = p;
+  while(*p >= '0' && *p <= '9' && p - start < 12){
+    value = value * 10 + (*p - '0');
+    ++p;
+  }
+  if(p == start || value < 1 || value > n){
+    return -1;
+  }
+  return (int) (value - 1);
+}
+
+static std::string mtx_line(const char* line_begin){
+  const char* line_end = std::strchr(line_begin, '\n');
+  return std::string(line_begin, line_end == nullptr ? line_begin + std::strlen(line_begin) : line_end);
+}
+
+// Parses the lines in [begin, end) (end is right after a '\n') into out.
+// Must not use the R API, it runs on worker threads.
+static void parse_mtx_lines(const char* begin, const char* end, const MtxHeader& header, MtxEntries& out){
+  const char* p = begin;
+  while(p < end){
+    const char* line_begin = p;
+    p = skip_blanks(p);
+    if(*p == '\n' || *p == '%'){
+      p = static_cast<const char*>(std::memchr(p, '\n', end - p)) + 1;
+      continue;
+    }
+    int row = parse_index(p, header.nrow);
+    int col = parse_index(p, header.ncol);
+    if(row < 0 || col < 0){
+      throw std::range_error("Invalid or out of bounds index in the MatrixMarket entry '" + mtx_line(line_begin) + "'");
+    }
+    double value = 1.0;
+    if(! header.pattern){
+      p = skip_blanks(p);
+      if(p[0] == 'N' && p[1] == 'A' && (p[2] == ' ' || p[2] == '\t' || p[2] == '\r' || p[2] == '\n')){
+        value = NA_REAL;
+        p += 2;
+      }else{
+        // strtod() would skip the newline if the value is missing
+        char* value_end = const_cast<char*>(p);
+        if(*p != '\n'){
+          value = std::strtod(p, &value_end);
+        }
+        if(value_end == p){
+          throw std::runtime_error("Cannot parse the value of the MatrixMarket entry '" + mtx_line(line_begin) + "'");
+        }
+        p = value_end;
+      }
+    }
+    out.rows.push_back(row);
+    out.cols.push_back(col);
+    out.values.push_back(value);
+    p = static_cast<const char*>(std::memchr(p, '\n', end - p)) + 1;
+  }
+}
+
+
+// Adds the entries to the accumulator of one margin (the rows if by_row,
+// otherwise the columns). The mirrored entries of a symmetric matrix are
+// added right after the original one.
+static void accumulate_mtx_entries(const std::vector<MtxEntries>& parts, const MtxHeader& header, bool by_row, RowMomentAccumulator& acc){
+  for(const MtxEntries& entries : parts){
+    const std::vector<int>& index = by_row ? entries.rows : entries.cols;
+    const std::vector<int>& other_index = by_row ? entries.cols : entries.rows;
+    for(size_t k = 0; k < entries.values.size(); ++k){
+      acc.add(index[k], entries.values[k]);
+      if(header.symmetry != 0 && index[k] != other_index[k]){
+        acc.add(other_index[k], header.symmetry * entries.values[k]);
+      }
+    }
+  }
+}
+
+
+static NumericMatrix summary_matrix(const RowMomentAccumulator& acc, double n_values, const std::vector<SummaryStat>& stat_codes){
+  R_len_t n = acc.count.size();
+  NumericMatrix result(n, stat_codes.size());
+  acc.write_summaries(n, n_values, stat_codes, result.begin(), 0, n);
+  return result;
+}
+
+
+// [[Rcpp::export]]
+List mtx_summary(std::string path, bool na_rm, CharacterVector stats, double chunk_size){
+  std::vector<SummaryStat> stat_codes = parse_summary_stats(stats);
+  int n_threads = get_n_threads();
+  std::unique_ptr<FILE, int(*)(FILE*)> file(std::fopen(path.c_str(), "rb"), std::fclose);
+  if(! file){
+    throw std::runtime_error("Cannot open the file " + path);
+  }
+  MtxHeader header = read_mtx_header(file.get());
+  RowMomentAccumulator row_acc(na_rm);
+  RowMomentAccumulator col_acc(na_rm);
+  row_acc.reset(0, header.nrow);
+  col_acc.reset(0, header.ncol);
+
+  R_xlen_t n_entries = 0;
+  std::vector<char> chunk;
+  std::vector<MtxEntries> parts(std::max(n_threads, 1));
+  ChunkReader reader(file.get(), (size_t) chunk_size);
+  while(reader.next(chunk)){
+    // Split the chunk at line boundaries, small chunks are not worth the threads
+    int n_parts = (int) std::min<size_t>(parts.size(), chunk.size() / (1 << 16) + 1);
+    std::vector<const char*> boundaries(n_parts + 1);
+    const char* chunk_end = chunk.data() + chunk.size();
+    boundaries[0] = chunk.data();
+    boundaries[n_parts] = chunk_end;
+    for(int k = 1; k < n_parts; ++k){
+      const char* split = std::max<const char*>(chunk.data() + chunk.size() * k / n_parts, boundaries[k - 1]);
+      const char* newline = static_cast<const char*>(std::memchr(split, '\n', chunk_end - split));
+      boundaries[k] = newline == nullptr ? chunk_end : newline + 1;
+    }
+    std::exception_ptr error = nullptr;
+#ifdef _OPENMP
+    #pragma omp parallel for num_threads(n_parts) schedule(static, 1)
+#endif
+    for(int k = 0; k < n_parts; ++k){
+      try{
+        parts[k].clear();
+        parse_mtx_lines(boundaries[k], boundaries[k + 1], header, parts[k]);
+      }catch(...){
+#ifdef _OPENMP
+        #pragma omp critical
+#endif
+        {
+          if(! error){
+            error = std::current_exception();
+          }
+        }
+      }
+    }
+    if(error){
+      std::rethrow_exception(error);
+    }
+    for(int k = n_parts; k < (int) parts.size(); ++k){
+      parts[k].clear();
+    }
+    for(const MtxEntries& entries : parts){
+      n_entries += entries.values.size();
+    }
+    if(n_entries > header.n_entries){
+      break;
+    }
+    // The two margins are independent
+#ifdef _OPENMP
+    #pragma omp parallel for num_threads(n_threads > 1 ? 2 : 1) schedule(static, 1)
+#endif
+    for(int margin = 0; margin < 2; ++margin){
+      accumulate_mtx_entries(parts, header, margin == 0, margin == 0 ? row_acc : col_acc);
+    }
+    Rcpp::checkUserInterrupt();
+  }
+  if(n_entries != header.n_entries){
+    throw std::runtime_error("The MatrixMarket file has " + std::string(n_entries > header.n_entries ? "more" : "fewer") +
+                             " entries than announced in its size line (" + std::to_string((long long) header.n_entries) + ")");
+  }
+  return List::create(Named("rows") = summary_matrix(row_acc, header.ncol, stat_codes),
+                      Named("cols") = summary_matrix(col_acc, header.nrow, stat_codes));
+}
@@ -3,6 +3,8 @@
 
 #include <Rcpp.h>
 #include "types.h"
+#include "ColumnSpan.h"
+#include "simd.h"
 
 template<typename Iterator>
 inline double sum_stable(Iterator iter){
@@ -15,23 +17,27 @@ inline double sum_stable(Iterator iter){
     return sum;
 }
 
+// Compensated sum of a contiguous column, see simd.h
+template<NaPolicy na_policy>
+inline double sum_stable(const ColumnSpan<double, na_policy>& span){
+    return simd_sum(span.begin(), span.size());
+}
 
-
-// This function was copied from https://stackoverflow.com/a/17299623/604854
-template <typename T>
-std::vector<T> flatten(const std::vector<std::vector<T>>& v) {
-    std::size_t total_size = 0;
-    for (const auto& sub : v){
-        total_size += sub.size(); // I wish there was a transform_accumulate
+// Sum of a logical (or integer) column. The values are added in a 64-bit
+// integer, which is exact; an NA turns the result into NA_REAL.
+template<NaPolicy na_policy>
+inline double sum_stable(const ColumnSpan<int, na_policy>& span){
+    int64_t sum = 0;
+    bool any_na = false;
+    for(int e : span){
+        any_na |= e == NA_INTEGER;
+        sum += e;
     }
-    std::vector<T> result;
-    result.reserve(total_size);
-    for (const auto& sub : v)
-        result.insert(result.end(), sub.begin(), sub.end());
-    return result;
+    return (na_policy == NaPolicy::Propagate && any_na) ? NA_REAL : (double) sum;
 }
 
 
+
 template<typename Iterator>
 inline bool is_any_na(Iterator iter){
     return std::any_of(iter.begin(), iter.end(), [](const double d) -> bool {
@@ -39,6 +45,17 @@ inline bool is_any_na(Iterator iter){
     });
 }
 
+// Spans with the Skip or AssumeNone policy cannot contain an NA
+template<typename T, NaPolicy na_policy>
+inline bool is_any_na(const ColumnSpan<T, na_policy>& span){
+    if(na_policy != NaPolicy::Propagate){
+        return false;
+    }
+    return std::any_of(span.begin(), span.end(), [](const T d) -> bool {
+        return is_na_value(d);
+    });
+}
+
 
 template<typename Iterator>
 inline bool are_all_na(Iterator iter){
@@ -47,6 +64,15 @@ inline bool are_all_na(Iterator iter){
     });
 }
 
+template<typename T, NaPolicy na_policy>
+inline bool are_all_na(const ColumnSpan<T, na_policy>& span){
+    if(na_policy != NaPolicy::Propagate){
+        return span.is_empty();
+    }
+    return std::all_of(span.begin(), span.end(), [](const T d) -> bool {
+        return is_na_value(d);
+    });
+}
 
 
 #endif /* my_utils_h */
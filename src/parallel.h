@@ -0,0 +1,202 @@
+#ifndef parallel_h
+#define parallel_h
+
+#include <Rcpp.h>
+#include <exception>
+#include "SparseMatrixView.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+
+// The number of worker threads is a package-level setting, controlled by
+// options(sparseMatrixStats.nthreads = n). The default is a single thread.
+// This function uses the R API and must only be called from the main thread.
+inline int get_n_threads(){
+#ifdef _OPENMP
+  SEXP option = Rf_GetOption1(Rf_install("sparseMatrixStats.nthreads"));
+  if(Rf_isNull(option)){
+    return 1;
+  }
+  int n_threads = Rf_asInteger(option);
+  if(n_threads == NA_INTEGER || n_threads < 1){
+    return 1;
+  }
+  return n_threads;
+#else
+  return 1;
+#endif
+}
+
+
+// The size of the L2 cache in bytes, which determines how the row functions
+// block their accumulators. Can be overridden with
+// options(sparseMatrixStats.l2_cache_size = bytes). Falls back to 256 KiB
+// if the size cannot be queried.
+// This function uses the R API and must only be called from the main thread.
+inline size_t get_l2_cache_size(){
+  SEXP option = Rf_GetOption1(Rf_install("sparseMatrixStats.l2_cache_size"));
+  if(! Rf_isNull(option)){
+    double size = Rf_asReal(option);
+    if(! ISNAN(size) && size >= 1024){
+      return (size_t) size;
+    }
+  }
+#ifdef _SC_LEVEL2_CACHE_SIZE
+  long size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+  if(size > 0){
+    return (size_t) size;
+  }
+#endif
+  return 256 * 1024;
+}
+
+
+// The maximum size in bytes of the transposed copy that the row functions
+// make of a row tile of a SparseStatsFile (see transpose_tile_rows()). Can be
+// set with options(sparseMatrixStats.transpose_block_size = bytes), the
+// default is 256 MiB.
+// This function uses the R API and must only be called from the main thread.
+inline size_t get_transpose_block_size(){
+  SEXP option = Rf_GetOption1(Rf_install("sparseMatrixStats.transpose_block_size"));
+  if(! Rf_isNull(option)){
+    double size = Rf_asReal(option);
+    if(! ISNAN(size) && size >= 1){
+      return (size_t) size;
+    }
+  }
+  return 256 * 1024 * 1024;
+}
+
+
+// Split the columns into n_chunks contiguous ranges, so that each range
+// contains roughly the same number of non-zero elements. Every column is
+// weighted with nnz + 1, so that empty columns are not free.
+// Returns n_chunks + 1 boundaries, chunk k covers [boundaries[k], boundaries[k+1]).
+template<typename NnzBefore>
+std::vector<R_len_t> partition_columns_by_nnz(NnzBefore nnz_before, R_len_t ncol, int n_chunks){
+  std::vector<R_len_t> boundaries(n_chunks + 1, ncol);
+  boundaries[0] = 0;
+  double total_weight = (double) nnz_before(ncol) + ncol;
+  for(int k = 1; k < n_chunks; ++k){
+    double target = total_weight * k / n_chunks;
+    R_len_t lower = boundaries[k-1];
+    R_len_t upper = ncol;
+    while(lower < upper){
+      R_len_t mid = lower + (upper - lower) / 2;
+      if((double) nnz_before(mid) + mid < target){
+        lower = mid + 1;
+      }else{
+        upper = mid;
+      }
+    }
+    boundaries[k] = lower;
+  }
+  return boundaries;
+}
+
+// For a view with a column subset, the number of non-zero elements in front
+// of each column is accumulated first (a single O(ncol) pass).
+template<int RTYPE>
+std::vector<R_len_t> partition_columns_by_nnz(const SparseMatrixView<RTYPE>& sp_mat, int n_chunks){
+  if(sp_mat.col_subset_ptr == nullptr){
+    return partition_columns_by_nnz([&sp_mat](R_len_t col) -> R_xlen_t {
+      return sp_mat.col_ptr(col);
+    }, sp_mat.ncol, n_chunks);
+  }
+  std::vector<R_xlen_t> prefix(sp_mat.ncol + 1, 0);
+  for(R_len_t col = 0; col < sp_mat.ncol; ++col){
+    prefix[col + 1] = prefix[col] + (sp_mat.col_end(col) - sp_mat.col_begin(col));
+  }
+  return partition_columns_by_nnz([&prefix](R_len_t col) -> R_xlen_t {
+    return prefix[col];
+  }, sp_mat.ncol, n_chunks);
+}
+
+
+// Call op(col_idx) for every column of the matrix. If n_threads > 1, the
+// columns are distributed across the threads in nnz-balanced chunks.
+// ATTENTION: op must not use the R API (no allocation, no Rcpp vector copies,
+// no R_CheckUserInterrupt()), because it might run on a worker thread.
+// Exceptions thrown by op are captured and rethrown on the main thread.
+template<int RTYPE, typename Functor>
+void parallel_for_columns(const SparseMatrixView<RTYPE>& sp_mat, int n_threads, Functor op){
+  R_len_t ncol = sp_mat.ncol;
+  if(n_threads <= 1 || ncol <= 1){
+    for(R_len_t col_idx = 0; col_idx < ncol; ++col_idx){
+      op(col_idx);
+    }
+    return;
+  }
+  // Use more chunks than threads, so that a few expensive columns
+  // do not leave the other threads idle
+  int n_chunks = (int) std::min<R_len_t>(ncol, n_threads * 4);
+  std::vector<R_len_t> boundaries = partition_columns_by_nnz(sp_mat, n_chunks);
+  std::exception_ptr error = nullptr;
+#ifdef _OPENMP
+  #pragma omp parallel for num_threads(n_threads) schedule(dynamic, 1)
+#endif
+  for(int chunk = 0; chunk < n_chunks; ++chunk){
+    try{
+      for(R_len_t col_idx = boundaries[chunk]; col_idx < boundaries[chunk + 1]; ++col_idx){
+        op(col_idx);
+      }
+    }catch(...){
+#ifdef _OPENMP
+      #pragma omp critical
+#endif
+      {
+        if(! error){
+          error = std::current_exception();
+        }
+      }
+    }
+  }
+  if(error){
+    std::rethrow_exception(error);
+  }
+}
+
+
+// Split the columns into n_chunks nnz-balanced ranges and call
+// op(chunk, col_begin, col_end) for each of them, every chunk on its own
+// thread. This is meant for kernels that scatter into per-thread
+// accumulators (e.g. the row functions) and merge them afterwards.
+// The same restrictions as for parallel_for_columns apply to op.
+template<int RTYPE, typename Functor>
+void parallel_for_column_chunks(const SparseMatrixView<RTYPE>& sp_mat, int n_chunks, Functor op){
+  if(n_chunks <= 1){
+    op(0, (R_len_t) 0, sp_mat.ncol);
+    return;
+  }
+  std::vector<R_len_t> boundaries = partition_columns_by_nnz(sp_mat, n_chunks);
+  std::exception_ptr error = nullptr;
+#ifdef _OPENMP
+  #pragma omp parallel for num_threads(n_chunks) schedule(static, 1)
+#endif
+  for(int chunk = 0; chunk < n_chunks; ++chunk){
+    try{
+      op(chunk, boundaries[chunk], boundaries[chunk + 1]);
+    }catch(...){
+#ifdef _OPENMP
+      #pragma omp critical
+#endif
+      {
+        if(! error){
+          error = std::current_exception();
+        }
+      }
+    }
+  }
+  if(error){
+    std::rethrow_exception(error);
+  }
+}
+
+
+#endif /* parallel_h */
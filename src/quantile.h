@@ -3,86 +3,317 @@
 
 
 #include <Rcpp.h>
-#include "VectorSubsetView.h"
+#include "ColumnSpan.h"
+#include "types.h"
 #include <cmath>
+#include <vector>
+#include <algorithm>
 
 using namespace Rcpp;
 
+// Type 7 quantile (the default of stats::quantile()) from the two order
+// statistics around pivot = (n-1) * prob
+inline double interpolate_quantile(double left_of_pivot, double right_of_pivot, double pivot){
+  if(left_of_pivot == R_NegInf && right_of_pivot == R_PosInf){
+    return R_NaN;
+  }else  if(left_of_pivot == R_NegInf){
+    return R_NegInf;
+  }else if(right_of_pivot == R_PosInf){
+    return R_PosInf;
+  }else{
+    return left_of_pivot + (right_of_pivot - left_of_pivot) * std::fmod(pivot, 1.0);
+  }
+}
+
+// The implicit zeros of a column form a single block right after the negative
+// values. If size <= rank < number_of_zeros, the rank falls into that block
+// no matter how many values are negative.
+inline bool rank_surely_zero(R_len_t rank, R_len_t size, R_len_t number_of_zeros){
+  return rank >= size && rank < number_of_zeros;
+}
+
+// Per-thread scratch space for select_rank_with_atom
+inline std::vector<double>& selection_buffer(){
+  thread_local std::vector<double> buffer;
+  return buffer;
+}
+
+// Per-thread scratch space for SortedSparseColumn
+inline std::vector<double>& sort_buffer(){
+  thread_local std::vector<double> buffer;
+  return buffer;
+}
+
+
+// The element at (0-based) rank of the values plus atom_count copies of
+// atom_value, which are never materialized. If next is not null, it also
+// stores the element at rank + 1 (which has to exist). The values are not
+// sorted: after counting the values below the atom, only the side of the atom
+// block that contains rank is copied and std::nth_element is run on it, so
+// this is O(nnz). Ranks inside the atom block return atom_value directly.
 // ATTENTION: This method assumes that NA's have already been handled!
 template<typename T>
-double quantile_sparse_impl(T values, int number_of_zeros, double prob){
+double select_rank_with_atom(const T& values, double atom_value, R_len_t atom_count, R_len_t rank, double* next = nullptr){
+  R_len_t size = values.size();
+  if(rank_surely_zero(rank, size, atom_count) && (next == nullptr || rank_surely_zero(rank + 1, size, atom_count))){
+    if(next != nullptr){
+      *next = atom_value;
+    }
+    return atom_value;
+  }
+  R_len_t n_below = std::count_if(values.begin(), values.end(), [atom_value](double d) -> bool {
+    return d < atom_value;
+  });
+  R_len_t atom_end = n_below + atom_count;
+  // Smallest value above the atom block, only needed at its upper border
+  auto min_above = [&values, atom_value]() -> double {
+    double min = R_PosInf;
+    for(double d : values){
+      if(d >= atom_value && d < min){
+        min = d;
+      }
+    }
+    return min;
+  };
+
+  std::vector<double>& buffer = selection_buffer();
+  buffer.clear();
+  double result;
+  if(rank < n_below){
+    std::copy_if(values.begin(), values.end(), std::back_inserter(buffer), [atom_value](double d) -> bool {
+      return d < atom_value;
+    });
+    std::nth_element(buffer.begin(), buffer.begin() + rank, buffer.end());
+    result = buffer[rank];
+    if(next != nullptr){
+      if(rank + 1 < n_below){
+        *next = *std::min_element(buffer.begin() + rank + 1, buffer.end());
+      }else if(atom_count > 0){
+        *next = atom_value;
+      }else{
+        *next = min_above();
+      }
+    }
+  }else if(rank < atom_end){
+    result = atom_value;
+    if(next != nullptr){
+      *next = rank + 1 < atom_end ? atom_value : min_above();
+    }
+  }else{
+    std::copy_if(values.begin(), values.end(), std::back_inserter(buffer), [atom_value](double d) -> bool {
+      return d >= atom_value;
+    });
+    R_len_t pos = rank - atom_end;
+    std::nth_element(buffer.begin(), buffer.begin() + pos, buffer.end());
+    result = buffer[pos];
+    if(next != nullptr){
+      *next = *std::min_element(buffer.begin() + pos + 1, buffer.end());
+    }
+  }
+  return result;
+}
+
+
+// The element at (0-based) rank of the complete column (the values plus
+// number_of_zeros zeros).
+// ATTENTION: This method assumes that NA's have already been handled!
+template<typename T>
+double select_sparse_rank(const T& values, R_len_t number_of_zeros, R_len_t rank, double* next = nullptr){
+  return select_rank_with_atom(values, 0.0, number_of_zeros, rank, next);
+}
+
+
+// The median (as in stats::median()) of the values plus atom_count copies of atom_value
+// ATTENTION: This method assumes that NA's have already been handled!
+template<typename T>
+double median_with_atom(const T& values, double atom_value, R_len_t atom_count){
+  R_len_t total_size = values.size() + atom_count;
+  if(total_size == 0){
+    return NA_REAL;
+  }
+  R_len_t half = (total_size - 1) / 2;
+  if(total_size % 2 == 1){
+    return select_rank_with_atom(values, atom_value, atom_count, half);
+  }else{
+    double right;
+    double left = select_rank_with_atom(values, atom_value, atom_count, half, &right);
+    return (left + right) / 2;
+  }
+}
+
+
+// Type 7 quantile of a sparse column via select_sparse_rank (O(nnz)).
+// ATTENTION: This method assumes that NA's have already been handled!
+template<typename T>
+double quantile_sparse_select(const T& values, R_len_t number_of_zeros, double prob){
   if(prob < 0 || prob > 1){
     throw std::range_error("prob must be between 0 and 1");
   }
-  R_len_t size = values.size();
-  int total_size = size + number_of_zeros;
+  R_len_t total_size = values.size() + number_of_zeros;
   if(total_size == 0){
     return NA_REAL;
-  }else if(size == 0){
-    return 0.0;
   }
   double pivot = (total_size-1) * prob;
-  // Rcout << "total_size: " << total_size << " pivot: " << pivot << std::endl;
-  std::vector<double> sorted_values;
-  std::copy(values.begin(), values.end(), std::back_inserter(sorted_values));
-  std::sort(sorted_values.begin(), sorted_values.end());
-  double left_of_pivot = NA_REAL;
-  double right_of_pivot = NA_REAL;
-  bool left_of_zero = sorted_values[0] < 0;
-  bool right_of_zero = !left_of_zero && number_of_zeros == 0;
-  int zero_counter = ! left_of_zero && ! right_of_zero;
-  int vec_counter = 0;
-  for(int i = 0; i < sorted_values.size() + number_of_zeros; i++){
-    // Rcout << i << " " << vec_counter << " " << zero_counter << " " << left_of_zero << " " << right_of_zero << " " << std::endl;
-    if(i == std::floor(pivot)){
-      if(! left_of_zero && ! right_of_zero){
-        left_of_pivot = 0;
-      }else{
-        left_of_pivot = sorted_values[vec_counter];
-      }
-      // Rcout << "left of pivot: " << i << " " << left_of_pivot << std::endl;
+  R_len_t left_rank = std::floor(pivot);
+  double left_of_pivot;
+  double right_of_pivot;
+  if(std::ceil(pivot) > left_rank){
+    left_of_pivot = select_sparse_rank(values, number_of_zeros, left_rank, &right_of_pivot);
+  }else{
+    left_of_pivot = select_sparse_rank(values, number_of_zeros, left_rank);
+    right_of_pivot = left_of_pivot;
+  }
+  return interpolate_quantile(left_of_pivot, right_of_pivot, pivot);
+}
+
+
+// Per-thread scratch space of (value, weight) pairs for weighted_median_select
+inline std::vector<std::pair<double, double> >& weighted_selection_buffer(){
+  thread_local std::vector<std::pair<double, double> > buffer;
+  return buffer;
+}
+
+// Weighted median of (value, weight) pairs, as matrixStats::weightedMedian()
+// with interpolate = FALSE: the smallest value at which the cumulative weight
+// reaches half of the total weight. If it hits exactly half, the result is the
+// mean of that value and the next larger one. Pairs with a weight that is
+// not positive are ignored. Uses a weighted quickselect (expected O(n)) that
+// reorders entries.
+// ATTENTION: This method assumes that NA's have already been handled!
+inline double weighted_median_select(std::vector<std::pair<double, double> >& entries){
+  entries.erase(std::remove_if(entries.begin(), entries.end(), [](const std::pair<double, double>& e) -> bool {
+    return ! (e.second > 0);
+  }), entries.end());
+  if(entries.empty()){
+    return NA_REAL;
+  }
+  LDOUBLE total_weight = 0.0;
+  for(const auto& e : entries){
+    total_weight += e.second;
+  }
+  double half = total_weight / 2;
+  auto lo = entries.begin();
+  auto hi = entries.end();
+  double weight_below = 0.0;
+  // The smallest value above [lo, hi), if any
+  double next_above = R_PosInf;
+  bool has_next_above = false;
+  auto weight_sum = [](std::vector<std::pair<double, double> >::iterator begin, std::vector<std::pair<double, double> >::iterator end) -> double {
+    LDOUBLE sum = 0.0;
+    for(; begin != end; ++begin){
+      sum += begin->second;
     }
-    if(i == std::ceil(pivot)){
-      if(! left_of_zero && ! right_of_zero){
-        right_of_pivot = 0;
-      }else{
-        right_of_pivot = sorted_values[vec_counter];
+    return sum;
+  };
+  while(true){
+    double pivot = (lo + (hi - lo) / 2)->first;
+    auto mid1 = std::partition(lo, hi, [pivot](const std::pair<double, double>& e) -> bool {
+      return e.first < pivot;
+    });
+    auto mid2 = std::partition(mid1, hi, [pivot](const std::pair<double, double>& e) -> bool {
+      return e.first == pivot;
+    });
+    double weight_less = weight_sum(lo, mid1);
+    double weight_equal = weight_sum(mid1, mid2);
+    if(mid1 != lo && weight_below + weight_less >= half){
+      next_above = pivot;
+      has_next_above = true;
+      hi = mid1;
+    }else if(weight_below + weight_less + weight_equal >= half){
+      if(weight_below + weight_less + weight_equal == half){
+        if(mid2 != hi){
+          double next = std::min_element(mid2, hi)->first;
+          return (pivot + next) / 2;
+        }else if(has_next_above){
+          return (pivot + next_above) / 2;
+        }
       }
-      // Rcout << "right of pivot: " << i << " " << right_of_pivot << std::endl;
-      break;
+      return pivot;
+    }else{
+      weight_below += weight_less + weight_equal;
+      lo = mid2;
     }
+  }
+}
 
-    if(left_of_zero){
-      vec_counter++;
-      if(vec_counter == size || sorted_values[vec_counter] > 0){
-        left_of_zero = false;
-      }
+
+// The stored values of a sparse column in sorted order, for many order
+// statistics / quantiles of the same column. The implicit zeros are never
+// materialized: they form a single block right after the negative values, so
+// the element at any rank can be read off in O(1). The values are only sorted
+// (once) when the first rank outside of the zero block is requested.
+// The values are copied into a per-thread buffer, so there can only be one
+// SortedSparseColumn per thread at a time.
+// ATTENTION: This class assumes that NA's have already been handled!
+template<typename T>
+class SortedSparseColumn {
+  const T& values;
+  R_len_t number_of_zeros;
+  std::vector<double>& sorted_values;
+  mutable R_len_t n_negative = -1;
+  mutable bool is_sorted = false;
+
+  void count_negative() const {
+    if(n_negative < 0){
+      n_negative = std::count_if(values.begin(), values.end(), [](double d) -> bool {
+        return d < 0;
+      });
     }
-    if(right_of_zero){
-      vec_counter++;
+  }
+
+  void sort() const {
+    if(! is_sorted){
+      sorted_values.assign(values.begin(), values.end());
+      std::sort(sorted_values.begin(), sorted_values.end());
+      is_sorted = true;
     }
-    if(! left_of_zero && ! right_of_zero){
-      zero_counter++;
-      if(zero_counter > number_of_zeros){
-        right_of_zero = true;
-      }
+  }
+
+public:
+  SortedSparseColumn(const T& values_, R_len_t number_of_zeros_):
+    values(values_), number_of_zeros(number_of_zeros_), sorted_values(sort_buffer()) {}
+
+  R_len_t size() const {
+    return values.size() + number_of_zeros;
+  }
+
+  // The element at (0-based) rank in the complete column
+  double at(R_len_t rank) const {
+    if(rank_surely_zero(rank, values.size(), number_of_zeros)){
+      return 0.0;
     }
+    count_negative();
+    if(rank >= n_negative && rank < n_negative + number_of_zeros){
+      return 0.0;
+    }
+    sort();
+    return rank < n_negative ? sorted_values[rank] : sorted_values[rank - number_of_zeros];
   }
-  if(left_of_pivot == R_NegInf && right_of_pivot == R_PosInf){
-    return R_NaN;
-  }else  if(left_of_pivot == R_NegInf){
-    return R_NegInf;
-  }else if(right_of_pivot == R_PosInf){
-    return R_PosInf;
-  }else{
-    return left_of_pivot + (right_of_pivot - left_of_pivot) * std::fmod(pivot, 1.0);
+
+  // Type 7 quantile (the default of stats::quantile())
+  double quantile(double prob) const {
+    if(prob < 0 || prob > 1){
+      throw std::range_error("prob must be between 0 and 1");
+    }
+    R_len_t total_size = size();
+    if(total_size == 0){
+      return NA_REAL;
+    }
+    double pivot = (total_size-1) * prob;
+    return interpolate_quantile(at(std::floor(pivot)), at(std::ceil(pivot)), pivot);
   }
+};
+
+template<typename T>
+SortedSparseColumn<T> make_sorted_sparse_column(const T& values, R_len_t number_of_zeros){
+  return SortedSparseColumn<T>(values, number_of_zeros);
 }
 
-// [[Rcpp::export]]
-double quantile_sparse(NumericVector values, int number_of_zeros, double prob){
-  VectorSubsetView<REALSXP> vsv(values, 0, values.size());
-  return quantile_sparse_impl<VectorSubsetView<REALSXP> >(vsv, number_of_zeros, prob);
+
+// ATTENTION: This method assumes that NA's have already been handled!
+template<typename T>
+double quantile_sparse_impl(T values, int number_of_zeros, double prob){
+  return quantile_sparse_select(values, number_of_zeros, prob);
 }
 
 #endif /* quantile_h */
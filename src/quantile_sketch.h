@@ -0,0 +1,294 @@
+#ifndef quantile_sketch_h
+#define quantile_sketch_h
+
+
+#include <Rcpp.h>
+#include "types.h"
+#include "quantile.h"
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+
+using namespace Rcpp;
+
+// Approximate quantiles with a merging t-digest (Dunning and Ertl, 2019).
+// The digest keeps the values as centroids (mean, weight, min, max) sorted by
+// mean. New values go into a buffer, which is folded into the centroids once
+// it is full: all entries are sorted and neighbours are combined greedily as
+// long as a centroid spans at most one unit of the scale function
+//   k(q) = compression / (2 * pi) * asin(2 * q - 1),
+// which keeps the centroids small at the tails and at most about
+// pi / compression of the values in the middle. There are at most about
+// compression centroids, so the memory does not grow with the number of
+// values. Two digests are merged by folding the centroids of one into the
+// other. A digest that got fewer values than its buffer holds (2 *
+// compression) is exact.
+class TDigest {
+  struct Centroid {
+    double mean;
+    double weight;
+    double min;
+    double max;
+
+    bool operator<(const Centroid& other) const {
+      return mean < other.mean;
+    }
+  };
+
+  double compression;
+  size_t buffer_capacity;
+  std::vector<Centroid> centroids;
+  std::vector<double> buffer;
+  double total_weight = 0;
+
+  // Per-thread scratch space for compress()
+  static std::vector<Centroid>& centroid_buffer(int i){
+    thread_local std::vector<Centroid> buffers[2];
+    return buffers[i];
+  }
+
+  static std::vector<double>& value_buffer(){
+    thread_local std::vector<double> buffer;
+    return buffer;
+  }
+
+  // Fold the buffer and the centroids of other (if not null) into the
+  // centroids. The centroids of both digests are sorted already, so only the
+  // buffered values are sorted and the three sequences are merged. The limit
+  // of the scale function is computed once per centroid: a centroid that
+  // starts at q_left may grow up to
+  //   q_limit = (sin(min(asin(2 * q_left - 1) + 2 * pi / compression, pi / 2)) + 1) / 2
+  // If merge_values is false, the values are kept as centroids of weight 1.
+  void compress(const TDigest* other, bool merge_values = true){
+    std::vector<double>& values = value_buffer();
+    values.assign(buffer.begin(), buffer.end());
+    double total = total_weight + buffer.size();
+    const std::vector<Centroid>* sorted_centroids = &centroids;
+    if(other != nullptr){
+      values.insert(values.end(), other->buffer.begin(), other->buffer.end());
+      total += other->total_weight + other->buffer.size();
+      std::vector<Centroid>& both = centroid_buffer(0);
+      both.clear();
+      std::merge(centroids.begin(), centroids.end(), other->centroids.begin(), other->centroids.end(), std::back_inserter(both));
+      sorted_centroids = &both;
+    }
+    std::sort(values.begin(), values.end());
+    std::vector<Centroid>& entries = centroid_buffer(1);
+    entries.clear();
+    auto c_it = sorted_centroids->begin();
+    auto c_end = sorted_centroids->end();
+    for(double v : values){
+      for(; c_it != c_end && c_it->mean < v; ++c_it){
+        entries.push_back(*c_it);
+      }
+      entries.push_back({v, 1.0, v, v});
+    }
+    entries.insert(entries.end(), c_it, c_end);
+    buffer.clear();
+    centroids.clear();
+    total_weight = total;
+    if(entries.empty()){
+      return;
+    }
+    if(! merge_values){
+      centroids.assign(entries.begin(), entries.end());
+      return;
+    }
+    double step = 2 * M_PI / compression;
+    double weight_before = 0;
+    double weight_limit = (std::sin(std::min(-M_PI / 2 + step, M_PI / 2)) + 1) / 2 * total;
+    Centroid current = entries[0];
+    for(size_t i = 1; i < entries.size(); ++i){
+      const Centroid& next = entries[i];
+      if(weight_before + current.weight + next.weight <= weight_limit){
+        current.weight += next.weight;
+        current.mean += (next.mean - current.mean) * next.weight / current.weight;
+        current.min = std::min(current.min, next.min);
+        current.max = std::max(current.max, next.max);
+      }else{
+        centroids.push_back(current);
+        weight_before += current.weight;
+        double q_left = std::min(weight_before / total, 1.0);
+        weight_limit = (std::sin(std::min(std::asin(2 * q_left - 1) + step, M_PI / 2)) + 1) / 2 * total;
+        current = next;
+      }
+    }
+    centroids.push_back(current);
+  }
+
+public:
+  explicit TDigest(double compression_):
+    compression(compression_), buffer_capacity(std::max<size_t>((size_t) (2 * std::ceil(compression_)), 16)) {}
+
+  void add(double v){
+    buffer.push_back(v);
+    if(buffer.size() >= buffer_capacity){
+      compress(nullptr);
+    }
+  }
+
+  void merge(const TDigest& other){
+    if(other.size() == 0){
+      return;
+    }
+    if(centroids.empty() && other.centroids.empty() && buffer.size() + other.buffer.size() < buffer_capacity){
+      buffer.insert(buffer.end(), other.buffer.begin(), other.buffer.end());
+      return;
+    }
+    compress(&other);
+  }
+
+  double size() const {
+    return total_weight + buffer.size();
+  }
+
+  // Fold the buffered values into the centroids, call this before at(). A
+  // digest that never had to compress its buffer keeps all values, so they
+  // are only sorted and the quantiles are exact.
+  void flush(){
+    if(! buffer.empty()){
+      compress(nullptr, ! centroids.empty());
+    }
+  }
+
+  // The approximate element at (0-based) rank of the values, rank is an
+  // integer in [0, size() - 1]. A centroid of weight w that starts after c
+  // values represents the ranks [c, c + w - 1]. Its mean is placed at their
+  // center, the ranks in between are interpolated linearly from the means of
+  // the neighbours (or the smallest / largest value at the ends), and the
+  // result is clamped to the range of the centroid. So a centroid of tied
+  // values returns exactly that value.
+  double at(double rank) const {
+    if(! buffer.empty()){
+      TDigest flushed(*this);
+      flushed.flush();
+      return flushed.at(rank);
+    }
+    double before = 0;
+    for(size_t i = 0; i < centroids.size(); ++i){
+      const Centroid& c = centroids[i];
+      if(rank < before + c.weight){
+        double center = before + (c.weight - 1) / 2;
+        double estimate = c.mean;
+        if(rank < center){
+          double left_rank = i > 0 ? before - (centroids[i - 1].weight + 1) / 2 : 0;
+          double left_value = i > 0 ? centroids[i - 1].mean : c.min;
+          estimate = left_value + (c.mean - left_value) * (rank - left_rank) / (center - left_rank);
+        }else if(rank > center){
+          bool last = i + 1 == centroids.size();
+          double right_rank = last ? total_weight - 1 : before + c.weight + (centroids[i + 1].weight - 1) / 2;
+          double right_value = last ? c.max : centroids[i + 1].mean;
+          estimate = c.mean + (right_value - c.mean) * (rank - center) / (right_rank - center);
+        }
+        return std::min(std::max(estimate, c.min), c.max);
+      }
+      before += c.weight;
+    }
+    return centroids.empty() ? NA_REAL : centroids.back().max;
+  }
+};
+
+
+// A t-digest of the values of a sparse column or row. Only the finite
+// non-zero values go into the digest, the zeros (implicit and stored) and the
+// infinite values are counted exactly. Like the sorted column of the exact
+// quantiles, the values are ordered as
+//   -Inf | negative values | zeros | positive values | Inf
+// so the implicit zeros are a single atom whose weight is only known at the
+// end. Ranks in the blocks of zeros and infinite values are exact, and the
+// estimates from the digest are clamped to the right side of zero.
+// ATTENTION: NA's have to be handled by the caller!
+class SparseQuantileSketch {
+  TDigest digest;
+  double n_negative = 0;
+  double n_stored_zeros = 0;
+  double n_neg_inf = 0;
+  double n_pos_inf = 0;
+  double max_negative = R_NegInf;
+  double min_positive = R_PosInf;
+
+  double digest_at(double rank) const {
+    if(rank < n_negative){
+      return std::min(digest.at(rank), max_negative);
+    }else{
+      return std::max(digest.at(rank), min_positive);
+    }
+  }
+
+public:
+  explicit SparseQuantileSketch(double compression): digest(compression) {}
+
+  void add(double v){
+    if(v == 0){
+      n_stored_zeros += 1;
+      return;
+    }else if(v == R_NegInf){
+      n_neg_inf += 1;
+      return;
+    }else if(v == R_PosInf){
+      n_pos_inf += 1;
+      return;
+    }
+    if(v < 0){
+      n_negative += 1;
+      max_negative = std::max(max_negative, v);
+    }else{
+      min_positive = std::min(min_positive, v);
+    }
+    digest.add(v);
+  }
+
+  void merge(const SparseQuantileSketch& other){
+    digest.merge(other.digest);
+    n_negative += other.n_negative;
+    n_stored_zeros += other.n_stored_zeros;
+    n_neg_inf += other.n_neg_inf;
+    n_pos_inf += other.n_pos_inf;
+    max_negative = std::max(max_negative, other.max_negative);
+    min_positive = std::min(min_positive, other.min_positive);
+  }
+
+  // Number of values that were added
+  double size() const {
+    return digest.size() + n_stored_zeros + n_neg_inf + n_pos_inf;
+  }
+
+  void flush(){
+    digest.flush();
+  }
+
+  // The approximate element at (0-based) rank of the values plus
+  // number_of_zeros implicit zeros
+  double at(double rank, double number_of_zeros) const {
+    double zeros = n_stored_zeros + number_of_zeros;
+    if(rank < n_neg_inf){
+      return R_NegInf;
+    }
+    rank -= n_neg_inf;
+    if(rank < n_negative){
+      return digest_at(rank);
+    }else if(rank < n_negative + zeros){
+      return 0;
+    }else if(rank < digest.size() + zeros){
+      return digest_at(rank - zeros);
+    }else{
+      return R_PosInf;
+    }
+  }
+
+  // Type 7 quantile (as stats::quantile()) of the values plus number_of_zeros
+  // implicit zeros. NA if there are no values. Call flush() first if the
+  // sketch is queried for several probabilities.
+  double quantile(double prob, double number_of_zeros) const {
+    double n = size() + number_of_zeros;
+    if(n == 0){
+      return NA_REAL;
+    }
+    double pivot = (n - 1) * prob;
+    return interpolate_quantile(at(std::floor(pivot), number_of_zeros), at(std::ceil(pivot), number_of_zeros), pivot);
+  }
+};
+
+
+#endif /* quantile_sketch_h */
@@ -1,132 +1,806 @@
 #include <Rcpp.h>
 #include "SparseMatrixView.h"
 #include "ColumnView.h"
-#include "VectorSubsetView.h"
-#include "SkipNAVectorSubsetView.h"
+#include "ColumnSpan.h"
 #include "types.h"
+#include "summary_stats.h"
+#include "quantile_sketch.h"
+#include "parallel.h"
 
 using namespace Rcpp;
 
 
 
-// [[Rcpp::export]]
-NumericVector dgCMatrix_rowSums2(S4 matrix, bool na_rm){
-  IntegerVector dim = matrix.slot("Dim");
-  NumericVector values = matrix.slot("x");
-  IntegerVector row_indices = matrix.slot("i");
-  std::vector<LDOUBLE> result (dim[0], 0.0);
-
-  double* val_iter = values.begin();
-  int* idx_iter = row_indices.begin();
-  while(val_iter != values.end() && idx_iter != row_indices.end()){
-    if(na_rm && ISNA(*val_iter)){
-      // Do nothing
-    }else{
-      result[*idx_iter] += *val_iter;
+// The row functions accumulate the non-zero elements per row. This is done
+// by reduce_rows() with an Accumulator that provides
+//   reset(row_begin, n_rows): start with the (empty) rows [row_begin, row_begin + n_rows)
+//   add(row, value):          add a value, row is relative to row_begin
+//   merge(other):             add the summaries of another accumulator for the same rows
+// and a finish(acc, row_begin, n_rows) function that writes the results.
+// There are two modes:
+//  * Scatter: if the accumulators for all rows fit into the L2 cache, each
+//    thread gets an nnz-balanced range of columns and its own accumulators
+//    for all rows, which are merged in column order at the end.
+//  * Row tiles: for very tall matrices, the rows are split into tiles whose
+//    accumulators fit into the L2 cache, and all columns are walked once per
+//    tile (with a cursor per column). The tiles are distributed across the
+//    threads, so each row is owned by a single thread and nothing is merged.
+// In both modes every row sees its values in column order, so the results do
+// not depend on the mode. Only the merge of several scatter accumulators can
+// change the rounding. The values of a logical matrix (lgCMatrixView) are
+// passed to add() as 0, 1, or NA_REAL.
+
+// Number of scatter accumulators: each one costs O(nrow) to set up and to
+// merge, so a thread is only used if it gets at least nrow non-zero elements.
+template<int RTYPE>
+int row_accumulator_count(const SparseMatrixView<RTYPE>& sp_mat, int n_threads){
+  R_xlen_t nnz = sp_mat.stored_size();
+  R_xlen_t useful = nnz / std::max<R_len_t>(sp_mat.nrow, 1);
+  R_xlen_t count = std::min<R_xlen_t>(std::min<R_xlen_t>(n_threads, useful), sp_mat.ncol);
+  return (int) std::max<R_xlen_t>(count, 1);
+}
+
+// Rows per tile, or 0 if the matrix should use the scatter mode. Tiles are
+// used if the accumulators of all rows exceed half of the L2 cache, and there
+// are enough non-zero elements per tile to pay for the walk over the column
+// cursors.
+template<int RTYPE>
+R_len_t row_tile_size(const SparseMatrixView<RTYPE>& sp_mat, size_t bytes_per_row, size_t l2_cache_size){
+  R_len_t tile_rows = std::max<R_len_t>(l2_cache_size / 2 / bytes_per_row, 1);
+  if(sp_mat.nrow <= tile_rows){
+    return 0;
+  }
+  R_xlen_t n_tiles = (sp_mat.nrow + tile_rows - 1) / tile_rows;
+  R_xlen_t nnz = sp_mat.stored_size();
+  if(n_tiles * sp_mat.ncol >= nnz){
+    return 0;
+  }
+  return tile_rows;
+}
+
+template<int RTYPE, typename Accumulator, typename Finish>
+void reduce_rows(const SparseMatrixView<RTYPE>& sp_mat, const Accumulator& init, size_t bytes_per_row, Finish finish){
+  R_len_t nrow = sp_mat.nrow;
+  R_len_t ncol = sp_mat.ncol;
+  const auto* val_ptr = sp_mat.values_ptr;
+  const int* idx_ptr = sp_mat.row_indices_ptr;
+  int n_threads = get_n_threads();
+  R_len_t tile_rows = row_tile_size(sp_mat, bytes_per_row, get_l2_cache_size());
+
+  if(tile_rows == 0){
+    int n_chunks = row_accumulator_count(sp_mat, n_threads);
+    std::vector<Accumulator> accs(n_chunks, init);
+    parallel_for_column_chunks(sp_mat, n_chunks, [&](int chunk, R_len_t col_begin, R_len_t col_end) -> void {
+      Accumulator& acc = accs[chunk];
+      acc.reset(0, nrow);
+      if(sp_mat.col_subset_ptr == nullptr && ! sp_mat.has_row_filter()){
+        for(R_xlen_t i = sp_mat.col_begin(col_begin); i < sp_mat.col_begin(col_end); ++i){
+          acc.add(idx_ptr[i], as_double_value(val_ptr[i]));
+        }
+        return;
+      }
+      for(R_len_t col = col_begin; col < col_end; ++col){
+        for(R_xlen_t i = sp_mat.col_begin(col); i < sp_mat.col_end(col); ++i){
+          int row = sp_mat.view_row(idx_ptr[i]);
+          if(row >= 0){
+            acc.add(row, as_double_value(val_ptr[i]));
+          }
+        }
+      }
+    });
+    for(int chunk = 1; chunk < n_chunks; ++chunk){
+      accs[0].merge(accs[chunk]);
     }
-    ++val_iter;
-    ++idx_iter;
+    finish(accs[0], 0, nrow);
+    return;
+  }
+
+  R_len_t n_tiles = (nrow + tile_rows - 1) / tile_rows;
+  int n_groups = (int) std::min<R_len_t>(std::max(n_threads, 1), n_tiles);
+  std::exception_ptr error = nullptr;
+#ifdef _OPENMP
+  #pragma omp parallel for num_threads(n_groups) schedule(static, 1)
+#endif
+  for(int group = 0; group < n_groups; ++group){
+    try{
+      R_len_t tile_begin = (R_len_t) ((R_xlen_t) n_tiles * group / n_groups);
+      R_len_t tile_end = (R_len_t) ((R_xlen_t) n_tiles * (group + 1) / n_groups);
+      int first_row = sp_mat.source_row(tile_begin * tile_rows);
+      // Position of the first element with a row index >= first_row in each column.
+      // The row indices of a column are sorted, so the cursors only move forward.
+      // The cursors work on the row indices of the slots, which are mapped to
+      // the rows of the view if it has a row filter.
+      std::vector<R_xlen_t> cursors(ncol);
+      for(R_len_t col = 0; col < ncol; ++col){
+        cursors[col] = std::lower_bound(idx_ptr + sp_mat.col_begin(col), idx_ptr + sp_mat.col_end(col), first_row) - idx_ptr;
+      }
+      Accumulator acc(init);
+      for(R_len_t tile = tile_begin; tile < tile_end; ++tile){
+        R_len_t row_begin = tile * tile_rows;
+        R_len_t row_end = std::min(row_begin + tile_rows, nrow);
+        int source_row_end = sp_mat.source_row(row_end);
+        acc.reset(row_begin, row_end - row_begin);
+        for(R_len_t col = 0; col < ncol; ++col){
+          R_xlen_t i = cursors[col];
+          R_xlen_t end = sp_mat.col_end(col);
+          while(i < end && idx_ptr[i] < source_row_end){
+            int row = sp_mat.view_row(idx_ptr[i]);
+            if(row >= 0){
+              acc.add(row - row_begin, as_double_value(val_ptr[i]));
+            }
+            ++i;
+          }
+          cursors[col] = i;
+        }
+        finish(acc, row_begin, row_end - row_begin);
+      }
+    }catch(...){
+#ifdef _OPENMP
+      #pragma omp critical
+#endif
+      {
+        if(! error){
+          error = std::current_exception();
+        }
+      }
+    }
+  }
+  if(error){
+    std::rethrow_exception(error);
   }
-  return wrap(result);
 }
 
 
 
-// [[Rcpp::export]]
-NumericVector dgCMatrix_rowMeans2(S4 matrix, bool na_rm){
-  IntegerVector dim = matrix.slot("Dim");
-  NumericVector values = matrix.slot("x");
-  IntegerVector row_indices = matrix.slot("i");
-  std::vector<LDOUBLE> result (dim[0], 0.0);
-  std::vector<int> nas_per_row (dim[0], 0);
-
-  double* val_iter = values.begin();
-  int* idx_iter = row_indices.begin();
-  auto val_end = values.end();
-  auto row_end = row_indices.end();
-  while(val_iter != val_end && idx_iter != row_end){
-    if(na_rm && ISNA(*val_iter)){
-      nas_per_row[*idx_iter] += 1;
+// Sum and number of removed NA's per row
+struct RowSumAccumulator {
+  bool na_rm;
+  std::vector<LDOUBLE> sums;
+  std::vector<int> nas;
+
+  explicit RowSumAccumulator(bool na_rm_): na_rm(na_rm_) {}
+
+  static const size_t bytes_per_row = sizeof(LDOUBLE) + sizeof(int);
+
+  void reset(R_len_t row_begin, R_len_t n_rows){
+    sums.assign(n_rows, 0.0);
+    nas.assign(n_rows, 0);
+  }
+
+  void add(R_len_t row, double v){
+    if(na_rm && ISNA(v)){
+      nas[row] += 1;
     }else{
-      result[*idx_iter] += *val_iter;
+      sums[row] += v;
     }
-    ++val_iter;
-    ++idx_iter;
   }
-  auto res_iter = result.begin();
-  auto res_end = result.end();
-  auto na_count_iter = nas_per_row.begin();
-  auto na_count_end = nas_per_row.end();
-  while(res_iter != res_end && na_count_iter != na_count_end){
-    *res_iter = *res_iter / (dim[1] - *na_count_iter);
-    ++res_iter;
-    ++na_count_iter;
+
+  void merge(const RowSumAccumulator& other){
+    for(size_t row = 0; row < sums.size(); ++row){
+      sums[row] += other.sums[row];
+      nas[row] += other.nas[row];
+    }
   }
+};
+
+
+// [[Rcpp::export]]
+NumericVector dgCMatrix_rowSums2(S4 matrix, bool na_rm, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return dispatch_sparse_view(matrix, rows, cols, [na_rm](const auto& sp_mat) -> NumericVector {
+    NumericVector result(sp_mat.nrow);
+    double* result_ptr = result.begin();
+    reduce_rows(sp_mat, RowSumAccumulator(na_rm), RowSumAccumulator::bytes_per_row,
+                [result_ptr](const RowSumAccumulator& acc, R_len_t row_begin, R_len_t n_rows) -> void {
+      for(R_len_t row = 0; row < n_rows; ++row){
+        result_ptr[row_begin + row] = acc.sums[row];
+      }
+    });
+    return result;
+  });
+}
+
+
 
-  return wrap(result);
+// [[Rcpp::export]]
+NumericVector dgCMatrix_rowMeans2(S4 matrix, bool na_rm, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return dispatch_sparse_view(matrix, rows, cols, [na_rm](const auto& sp_mat) -> NumericVector {
+    R_len_t ncol = sp_mat.ncol;
+    NumericVector result(sp_mat.nrow);
+    double* result_ptr = result.begin();
+    reduce_rows(sp_mat, RowSumAccumulator(na_rm), RowSumAccumulator::bytes_per_row,
+                [result_ptr, ncol](const RowSumAccumulator& acc, R_len_t row_begin, R_len_t n_rows) -> void {
+      for(R_len_t row = 0; row < n_rows; ++row){
+        result_ptr[row_begin + row] = acc.sums[row] / (ncol - acc.nas[row]);
+      }
+    });
+    return result;
+  });
 }
 
 
 
+// Per-row accumulators for dgCMatrix_rowVars. Without a center, the stored
+// elements of each row are summarized with Welford's algorithm (count, mean,
+// sum of squared deviations), which needs only a single pass over the data.
+// The mean is kept relative to the first element of the row (shift), so that
+// rows with a large offset do not lose precision.
+// With a center, m2 is the plain sum of squared deviations from it.
+struct RowVarAccumulator {
+  bool na_rm;
+  const double* center;
+  R_len_t row_begin = 0;
+  std::vector<int> count;
+  std::vector<int> nas;
+  std::vector<double> shift;
+  std::vector<LDOUBLE> mean;
+  std::vector<LDOUBLE> m2;
+
+  RowVarAccumulator(bool na_rm_, const double* center_): na_rm(na_rm_), center(center_) {}
 
+  static const size_t bytes_per_row = 2 * sizeof(int) + sizeof(double) + 2 * sizeof(LDOUBLE);
+
+  void reset(R_len_t row_begin_, R_len_t n_rows){
+    row_begin = row_begin_;
+    count.assign(n_rows, 0);
+    nas.assign(n_rows, 0);
+    m2.assign(n_rows, 0.0);
+    if(center == nullptr){
+      shift.assign(n_rows, 0.0);
+      mean.assign(n_rows, 0.0);
+    }
+  }
+
+  void add(R_len_t row, double v){
+    if(na_rm && ISNA(v)){
+      nas[row] += 1;
+    }else if(center != nullptr){
+      LDOUBLE diff = v - center[row_begin + row];
+      m2[row] += diff * diff;
+      count[row] += 1;
+    }else{
+      int n = ++count[row];
+      if(n == 1){
+        shift[row] = v;
+      }
+      LDOUBLE x = (LDOUBLE) v - shift[row];
+      LDOUBLE delta = x - mean[row];
+      mean[row] += delta / n;
+      m2[row] += delta * (x - mean[row]);
+    }
+  }
+
+  LDOUBLE absolute_mean(R_len_t row) const {
+    return shift[row] + mean[row];
+  }
+
+  // The variance of a row with n_values elements (the stored ones, the
+  // removed NA's, and the implicit zeros)
+  double variance(R_len_t row, R_len_t n_values) const {
+    R_len_t size = n_values - nas[row];
+    if(size - 1 < 0){
+      return R_NaN;
+    }
+    // The implicit zeros of the row
+    R_len_t number_of_zeros = size - count[row];
+    LDOUBLE m2_total;
+    if(center != nullptr){
+      double c = center[row_begin + row];
+      m2_total = m2[row] + (LDOUBLE) number_of_zeros * c * c;
+    }else if(count[row] == 0){
+      m2_total = 0.0;
+    }else{
+      LDOUBLE mu = absolute_mean(row);
+      m2_total = m2[row] + mu * mu * count[row] * number_of_zeros / size;
+    }
+    return m2_total / (size - 1);
+  }
+
+  // Chan et al.'s update to combine the summaries of two disjoint sets of columns
+  void merge(const RowVarAccumulator& other){
+    for(size_t row = 0; row < count.size(); ++row){
+      nas[row] += other.nas[row];
+      int n_other = other.count[row];
+      if(n_other == 0){
+        continue;
+      }
+      if(center != nullptr){
+        m2[row] += other.m2[row];
+      }else if(count[row] == 0){
+        shift[row] = other.shift[row];
+        mean[row] = other.mean[row];
+        m2[row] = other.m2[row];
+      }else{
+        int n = count[row] + n_other;
+        LDOUBLE delta = ((LDOUBLE) other.shift[row] - shift[row]) + (other.mean[row] - mean[row]);
+        m2[row] += other.m2[row] + delta * delta * count[row] * n_other / n;
+        mean[row] += delta * n_other / n;
+      }
+      count[row] += n_other;
+    }
+  }
+};
 
 // [[Rcpp::export]]
-NumericVector dgCMatrix_rowVars(S4 matrix, bool na_rm, Nullable<NumericVector> center){
+NumericVector dgCMatrix_rowVars(S4 matrix, bool na_rm, Nullable<NumericVector> center, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
   bool center_provided = center.isNotNull();
-  NumericVector means(0);
+  NumericVector center_vec(0);
   if(center_provided){
-    means = Rcpp::as<NumericVector>(center.get());
-  }else{
-    means = dgCMatrix_rowMeans2(matrix, na_rm);
-  }
-  IntegerVector dim = matrix.slot("Dim");
-  NumericVector values = matrix.slot("x");
-  IntegerVector row_indices = matrix.slot("i");
-  std::vector<LDOUBLE> result (dim[0], 0.0);
-  std::vector<int> nas_per_row (dim[0], 0);
-  std::vector<int> zeros_per_row (dim[0], dim[1]);
-
-  double* val_iter = values.begin();
-  auto val_end = values.end();
-  int* idx_iter = row_indices.begin();
-  auto idx_end = row_indices.end();
-  while(val_iter != val_end && idx_iter != idx_end){
-    if(na_rm && ISNA(*val_iter)){
-      nas_per_row[*idx_iter] += 1;
+    center_vec = Rcpp::as<NumericVector>(center.get());
+  }
+  const double* center_ptr = center_provided ? center_vec.begin() : nullptr;
+  return dispatch_sparse_view(matrix, rows, cols, [na_rm, center_ptr](const auto& sp_mat) -> NumericVector {
+    R_len_t ncol = sp_mat.ncol;
+    NumericVector result(sp_mat.nrow);
+    double* result_ptr = result.begin();
+    reduce_rows(sp_mat, RowVarAccumulator(na_rm, center_ptr), RowVarAccumulator::bytes_per_row,
+                [result_ptr, ncol](const RowVarAccumulator& acc, R_len_t row_begin, R_len_t n_rows) -> void {
+      for(R_len_t row = 0; row < n_rows; ++row){
+        result_ptr[row_begin + row] = acc.variance(row, ncol);
+      }
+    });
+    return result;
+  });
+}
+
+
+
+// Number of stored elements, NA's, and elements equal to value per row
+struct RowCountAccumulator {
+  double value;
+  std::vector<int> stored;
+  std::vector<int> nas;
+  std::vector<int> matches;
+
+  explicit RowCountAccumulator(double value_): value(value_) {}
+
+  static const size_t bytes_per_row = 3 * sizeof(int);
+
+  void reset(R_len_t row_begin, R_len_t n_rows){
+    stored.assign(n_rows, 0);
+    nas.assign(n_rows, 0);
+    matches.assign(n_rows, 0);
+  }
+
+  void add(R_len_t row, double v){
+    stored[row] += 1;
+    if(ISNAN(v)){
+      nas[row] += 1;
     }else{
-      LDOUBLE diff = (*val_iter - means[*idx_iter]);
-      result[*idx_iter] += diff * diff;
-    }
-    zeros_per_row[*idx_iter] -= 1;
-    ++val_iter;
-    ++idx_iter;
-  }
-  auto res_iter = result.begin();
-  auto res_end = result.end();
-  auto na_count_iter = nas_per_row.begin();
-  auto na_count_end = nas_per_row.end();
-  auto zero_count_iter = zeros_per_row.begin();
-  auto zero_count_end = zeros_per_row.end();
-  auto mean_iter = means.begin();
-  auto mean_end = means.end();
-  while(res_iter != res_end &&
-        na_count_iter != na_count_end &&
-        zero_count_iter != zero_count_end &&
-        mean_iter != mean_end){
-    if(dim[1] - *na_count_iter - 1 < 0){
-      *res_iter = R_NaN;
+      matches[row] += v == value;
+    }
+  }
+
+  void merge(const RowCountAccumulator& other){
+    for(size_t row = 0; row < stored.size(); ++row){
+      stored[row] += other.stored[row];
+      nas[row] += other.nas[row];
+      matches[row] += other.matches[row];
+    }
+  }
+};
+
+
+// [[Rcpp::export]]
+IntegerVector dgCMatrix_rowCounts(S4 matrix, double value, bool na_rm, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return dispatch_sparse_view(matrix, rows, cols, [value, na_rm](const auto& sp_mat) -> IntegerVector {
+    R_len_t ncol = sp_mat.ncol;
+    IntegerVector result(sp_mat.nrow);
+    int* result_ptr = result.begin();
+    reduce_rows(sp_mat, RowCountAccumulator(value), RowCountAccumulator::bytes_per_row,
+                [result_ptr, ncol, value, na_rm](const RowCountAccumulator& acc, R_len_t row_begin, R_len_t n_rows) -> void {
+      for(R_len_t row = 0; row < n_rows; ++row){
+        if(! na_rm && acc.nas[row] > 0){
+          result_ptr[row_begin + row] = NA_INTEGER;
+        }else if(value == 0.0){
+          result_ptr[row_begin + row] = ncol - acc.stored[row] + acc.matches[row];
+        }else{
+          result_ptr[row_begin + row] = acc.matches[row];
+        }
+      }
+    });
+    return result;
+  });
+}
+
+
+
+// Whether a row contains any NA
+struct RowAnyNAAccumulator {
+  std::vector<int> any_na;
+
+  static const size_t bytes_per_row = sizeof(int);
+
+  void reset(R_len_t row_begin, R_len_t n_rows){
+    any_na.assign(n_rows, false);
+  }
+
+  void add(R_len_t row, double v){
+    any_na[row] |= ISNAN(v);
+  }
+
+  void merge(const RowAnyNAAccumulator& other){
+    for(size_t row = 0; row < any_na.size(); ++row){
+      any_na[row] |= other.any_na[row];
+    }
+  }
+};
+
+
+// [[Rcpp::export]]
+LogicalVector dgCMatrix_rowAnyNAs(S4 matrix, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  return dispatch_sparse_view(matrix, rows, cols, [](const auto& sp_mat) -> LogicalVector {
+    LogicalVector result(sp_mat.nrow);
+    int* result_ptr = result.begin();
+    reduce_rows(sp_mat, RowAnyNAAccumulator(), RowAnyNAAccumulator::bytes_per_row,
+                [result_ptr](const RowAnyNAAccumulator& acc, R_len_t row_begin, R_len_t n_rows) -> void {
+      std::copy(acc.any_na.begin(), acc.any_na.end(), result_ptr + row_begin);
+    });
+    return result;
+  });
+}
+
+
+
+// A quantile sketch (see quantile_sketch.h) and the number of NA's per row.
+// The centroids of the sketches live on the heap and grow with the number of
+// values in a row up to a bound that depends only on the compression, so the
+// row quantiles need neither the transposed matrix nor memory that grows with
+// ncol.
+struct RowQuantileSketchAccumulator {
+  double compression;
+  std::vector<SparseQuantileSketch> sketches;
+  std::vector<int> nas;
+
+  explicit RowQuantileSketchAccumulator(double compression_): compression(compression_) {}
+
+  // The sketch objects plus their heap storage: the buffer of the t-digest
+  // (2 * compression values) and up to about compression centroids of 4
+  // doubles each
+  static size_t bytes_per_row(double compression){
+    return sizeof(SparseQuantileSketch) + sizeof(int) +
+      (size_t) (2 * std::ceil(compression) + 4 * compression) * sizeof(double);
+  }
+
+  void reset(R_len_t row_begin, R_len_t n_rows){
+    sketches.assign(n_rows, SparseQuantileSketch(compression));
+    nas.assign(n_rows, 0);
+  }
+
+  void add(R_len_t row, double v){
+    if(ISNAN(v)){
+      ++nas[row];
+    }else{
+      sketches[row].add(v);
+    }
+  }
+
+  void merge(const RowQuantileSketchAccumulator& other){
+    for(size_t row = 0; row < sketches.size(); ++row){
+      sketches[row].merge(other.sketches[row]);
+      nas[row] += other.nas[row];
+    }
+  }
+};
+
+
+// [[Rcpp::export]]
+NumericMatrix dgCMatrix_rowQuantilesApprox(S4 matrix, NumericVector probs, bool na_rm, double compression, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  if(! (compression >= 10)){
+    throw std::range_error("The compression of the quantile sketch must be at least 10");
+  }
+  for(double prob : probs){
+    if(! (prob >= 0 && prob <= 1)){
+      throw std::range_error("prob must be between 0 and 1");
+    }
+  }
+  return dispatch_sparse_view(matrix, rows, cols, [&probs, na_rm, compression](const auto& sp_mat) -> NumericMatrix {
+    R_len_t nrow = sp_mat.nrow;
+    R_len_t ncol = sp_mat.ncol;
+    R_len_t n_probs = probs.size();
+    const double* probs_ptr = probs.begin();
+    NumericMatrix result(nrow, n_probs);
+    double* result_ptr = result.begin();
+    reduce_rows(sp_mat, RowQuantileSketchAccumulator(compression), RowQuantileSketchAccumulator::bytes_per_row(compression),
+                [result_ptr, probs_ptr, n_probs, nrow, ncol, na_rm](const RowQuantileSketchAccumulator& acc, R_len_t row_begin, R_len_t n_rows) -> void {
+      for(R_len_t row = 0; row < n_rows; ++row){
+        double* out = result_ptr + row_begin + row;
+        if(acc.nas[row] > 0 && ! na_rm){
+          for(R_len_t i = 0; i < n_probs; ++i){
+            out[(R_xlen_t) i * nrow] = NA_REAL;
+          }
+          continue;
+        }
+        SparseQuantileSketch sketch(acc.sketches[row]);
+        sketch.flush();
+        double number_of_zeros = ncol - acc.nas[row] - sketch.size();
+        for(R_len_t i = 0; i < n_probs; ++i){
+          out[(R_xlen_t) i * nrow] = sketch.quantile(probs_ptr[i], number_of_zeros);
+        }
+      }
+    });
+    return result;
+  });
+}
+
+
+
+
+
+// A single pass over the non-zero elements: each row is summarized with
+// RowMomentAccumulator (see summary_stats.h), the same summary that the
+// streaming functions use.
+// [[Rcpp::export]]
+NumericMatrix dgCMatrix_rowSummary(S4 matrix, bool na_rm, CharacterVector stats, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  std::vector<SummaryStat> stat_codes = parse_summary_stats(stats);
+  return dispatch_sparse_view(matrix, rows, cols, [&stat_codes, na_rm](const auto& sp_mat) -> NumericMatrix {
+    R_len_t nrow = sp_mat.nrow;
+    R_len_t ncol = sp_mat.ncol;
+    NumericMatrix result(nrow, stat_codes.size());
+    double* result_ptr = result.begin();
+    reduce_rows(sp_mat, RowMomentAccumulator(na_rm), RowMomentAccumulator::bytes_per_row,
+                [&stat_codes, result_ptr, nrow, ncol](const RowMomentAccumulator& acc, R_len_t row_begin, R_len_t n_rows) -> void {
+      acc.write_summaries(n_rows, ncol, stat_codes, result_ptr, row_begin, nrow);
+    });
+    return result;
+  });
+}
+
+
+
+/*---------------Streaming accumulators-----------------*/
+
+// Adds the columns of matrix to the state of a row statistics accumulator
+// (NULL for an accumulator that has not seen any block yet) and returns the
+// new state. The block is reduced with reduce_rows(), the per-row summaries
+// are then combined with the state.
+// [[Rcpp::export]]
+NumericMatrix dgCMatrix_rowStatsAccumulate(S4 matrix, Nullable<NumericMatrix> state, bool na_rm){
+  return dispatch_sparse_view(matrix, R_NilValue, R_NilValue, [state, na_rm](const auto& sp_mat) -> NumericMatrix {
+    RowMomentAccumulator total(na_rm);
+    if(state.isNull()){
+      total.reset(0, sp_mat.nrow);
     }else{
-      *res_iter = ((*res_iter) + (*zero_count_iter) * (*mean_iter) * (*mean_iter)) / (dim[1] - *na_count_iter - 1);
+      total.read_state(NumericMatrix(state.get()));
+      if((R_len_t) total.count.size() != sp_mat.nrow){
+        throw std::range_error("The block must have the same number of rows as the previous blocks");
+      }
+    }
+    // The row ranges passed to finish() are disjoint, so it can run on several threads
+    reduce_rows(sp_mat, RowMomentAccumulator(na_rm), RowMomentAccumulator::bytes_per_row,
+                [&total](const RowMomentAccumulator& acc, R_len_t row_begin, R_len_t n_rows) -> void {
+      total.merge_rows(acc, row_begin);
+    });
+    return total.state();
+  });
+}
+
+
+// The state of an accumulator that has seen the blocks of both
+// [[Rcpp::export]]
+NumericMatrix rowStatsAccumulator_merge(NumericMatrix state1, NumericMatrix state2){
+  RowMomentAccumulator acc1(false);
+  RowMomentAccumulator acc2(false);
+  acc1.read_state(state1);
+  acc2.read_state(state2);
+  if(acc1.count.size() != acc2.count.size()){
+    throw std::range_error("Only accumulators with the same number of rows can be merged");
+  }
+  acc1.merge(acc2);
+  return acc1.state();
+}
+
+
+// [[Rcpp::export]]
+NumericMatrix rowStatsAccumulator_result(NumericMatrix state, double n_cols, bool na_rm, CharacterVector stats){
+  std::vector<SummaryStat> stat_codes = parse_summary_stats(stats);
+  RowMomentAccumulator acc(na_rm);
+  acc.read_state(state);
+  R_len_t nrow = state.nrow();
+  NumericMatrix result(nrow, stat_codes.size());
+  acc.write_summaries(nrow, n_cols, stat_codes, result.begin(), 0, nrow);
+  return result;
+}
+
+
+/*---------------Grouped aggregation-----------------*/
+
+// The members (columns or rows) of each group. group contains 1-based group
+// ids, the members of group g are members[offsets[g]] ... members[offsets[g+1] - 1]
+// in increasing order (counting sort over the ids).
+struct GroupIndex {
+  int n_groups;
+  std::vector<int> ids;
+  std::vector<int> offsets;
+  std::vector<int> members;
+
+  GroupIndex(IntegerVector group, int n_groups_): n_groups(n_groups_), ids(group.size()), offsets(std::max(n_groups_, 0) + 1, 0), members(group.size()) {
+    if(n_groups < 0){
+      throw std::range_error("n_groups must not be negative");
+    }
+    for(R_len_t k = 0; k < group.size(); ++k){
+      if(group[k] == NA_INTEGER || group[k] < 1 || group[k] > n_groups){
+        throw std::range_error("group must only contain values between 1 and the number of groups");
+      }
+      ids[k] = group[k] - 1;
+      ++offsets[ids[k] + 1];
+    }
+    for(int g = 0; g < n_groups; ++g){
+      offsets[g + 1] += offsets[g];
+    }
+    std::vector<int> next_pos(offsets.begin(), offsets.end() - 1);
+    for(R_len_t k = 0; k < group.size(); ++k){
+      members[next_pos[ids[k]]++] = k;
+    }
+  }
+
+  R_len_t size(int g) const {
+    return offsets[g + 1] - offsets[g];
+  }
+};
+
+
+// Every group of columns is accumulated into its own set of row accumulators
+// in one pass over the columns of the group. The groups are distributed
+// across the threads, each thread reuses one Accumulator and writes the
+// results of a group with finish(acc, group, n_columns_in_group), so nothing
+// has to be merged.
+template<int RTYPE, typename Accumulator, typename Finish>
+void reduce_rows_by_column_group(const SparseMatrixView<RTYPE>& sp_mat, const GroupIndex& groups, const Accumulator& init, Finish finish){
+  const auto* val_ptr = sp_mat.values_ptr;
+  const int* idx_ptr = sp_mat.row_indices_ptr;
+  int n_groups = groups.n_groups;
+  int n_threads = std::max(std::min(get_n_threads(), n_groups), 1);
+  std::exception_ptr error = nullptr;
+#ifdef _OPENMP
+  #pragma omp parallel num_threads(n_threads)
+#endif
+  {
+    Accumulator acc(init);
+#ifdef _OPENMP
+    #pragma omp for schedule(dynamic, 1)
+#endif
+    for(int g = 0; g < n_groups; ++g){
+      try{
+        acc.reset(0, sp_mat.nrow);
+        for(int k = groups.offsets[g]; k < groups.offsets[g + 1]; ++k){
+          R_len_t col = groups.members[k];
+          for(R_xlen_t i = sp_mat.col_begin(col); i < sp_mat.col_end(col); ++i){
+            int row = sp_mat.view_row(idx_ptr[i]);
+            if(row >= 0){
+              acc.add(row, as_double_value(val_ptr[i]));
+            }
+          }
+        }
+        finish(acc, g, groups.size(g));
+      }catch(...){
+#ifdef _OPENMP
+        #pragma omp critical
+#endif
+        {
+          if(! error){
+            error = std::current_exception();
+          }
+        }
+      }
     }
-    ++res_iter;
-    ++na_count_iter;
-    ++zero_count_iter;
-    ++mean_iter;
   }
-  return wrap(result);
+  if(error){
+    std::rethrow_exception(error);
+  }
 }
 
 
+// The transposed problem: every column is accumulated into one accumulator
+// per group of rows and written with finish(acc, col). The columns are split
+// into nnz-balanced ranges, one per thread.
+template<int RTYPE, typename Accumulator, typename Finish>
+void reduce_columns_by_row_group(const SparseMatrixView<RTYPE>& sp_mat, const GroupIndex& groups, const Accumulator& init, Finish finish){
+  const auto* val_ptr = sp_mat.values_ptr;
+  const int* idx_ptr = sp_mat.row_indices_ptr;
+  const int* group_ids = groups.ids.data();
+  int n_chunks = (int) std::max<R_len_t>(std::min<R_len_t>(get_n_threads(), sp_mat.ncol), 1);
+  parallel_for_column_chunks(sp_mat, n_chunks, [&](int chunk, R_len_t col_begin, R_len_t col_end) -> void {
+    Accumulator acc(init);
+    for(R_len_t col = col_begin; col < col_end; ++col){
+      acc.reset(0, groups.n_groups);
+      for(R_xlen_t i = sp_mat.col_begin(col); i < sp_mat.col_end(col); ++i){
+        int row = sp_mat.view_row(idx_ptr[i]);
+        if(row >= 0){
+          acc.add(group_ids[row], as_double_value(val_ptr[i]));
+        }
+      }
+      finish(acc, col);
+    }
+  });
+}
 
 
+// Calls driver(init, statistic) with the accumulator that is needed for stat
+// and a function statistic(acc, row, n_values) that calculates the result for
+// a row of the accumulator, which summarizes n_values elements. The
+// statistics have the same semantics as in rowSums2(), rowMeans2(), rowVars(),
+// and the "nnz" of rowSummary().
+template<typename Driver>
+void dispatch_group_stat(SummaryStat stat, bool na_rm, Driver driver){
+  switch(stat){
+  case SummaryStat::Sum:
+    driver(RowSumAccumulator(na_rm), [](const RowSumAccumulator& acc, R_len_t row, R_len_t n_values) -> double {
+      return acc.sums[row];
+    });
+    break;
+  case SummaryStat::Mean:
+    driver(RowSumAccumulator(na_rm), [](const RowSumAccumulator& acc, R_len_t row, R_len_t n_values) -> double {
+      return acc.sums[row] / (n_values - acc.nas[row]);
+    });
+    break;
+  case SummaryStat::Var:
+    driver(RowVarAccumulator(na_rm, nullptr), [](const RowVarAccumulator& acc, R_len_t row, R_len_t n_values) -> double {
+      return acc.variance(row, n_values);
+    });
+    break;
+  case SummaryStat::Nnz:
+    driver(RowCountAccumulator(0.0), [na_rm](const RowCountAccumulator& acc, R_len_t row, R_len_t n_values) -> double {
+      if(! na_rm && acc.nas[row] > 0){
+        return NA_REAL;
+      }
+      return acc.stored[row] - acc.nas[row] - acc.matches[row];
+    });
+    break;
+  default:
+    throw std::runtime_error("Can only aggregate 'sum', 'mean', 'var', and 'nnz' by group.");
+  }
+}
 
+
+// A statistic of each row within each group of columns (pseudobulk). group
+// assigns every column to one of n_groups groups (1-based). The result has
+// one column per group.
+// [[Rcpp::export]]
+NumericMatrix dgCMatrix_rowStatsByGroup(S4 matrix, IntegerVector group, int n_groups, CharacterVector stat, bool na_rm, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  SummaryStat stat_code = parse_summary_stats(stat).at(0);
+  return dispatch_sparse_view(matrix, rows, cols, [&group, n_groups, stat_code, na_rm](const auto& sp_mat) -> NumericMatrix {
+    if(group.size() != sp_mat.ncol){
+      throw std::range_error("The length of group must match the number of columns");
+    }
+    GroupIndex groups(group, n_groups);
+    R_len_t nrow = sp_mat.nrow;
+    NumericMatrix result(nrow, n_groups);
+    double* result_ptr = result.begin();
+    dispatch_group_stat(stat_code, na_rm, [&](auto init, auto statistic) -> void {
+      typedef decltype(init) Accumulator;
+      reduce_rows_by_column_group(sp_mat, groups, init, [result_ptr, nrow, statistic](const Accumulator& acc, int g, R_len_t n_values) -> void {
+        double* out = result_ptr + (R_xlen_t) g * nrow;
+        for(R_len_t row = 0; row < nrow; ++row){
+          out[row] = statistic(acc, row, n_values);
+        }
+      });
+    });
+    return result;
+  });
+}
+
+
+// A statistic of each column within each group of rows. group assigns every
+// row to one of n_groups groups (1-based). The result has one row per group.
+// [[Rcpp::export]]
+NumericMatrix dgCMatrix_colStatsByGroup(S4 matrix, IntegerVector group, int n_groups, CharacterVector stat, bool na_rm, Nullable<IntegerVector> rows = R_NilValue, Nullable<IntegerVector> cols = R_NilValue){
+  SummaryStat stat_code = parse_summary_stats(stat).at(0);
+  return dispatch_sparse_view(matrix, rows, cols, [&group, n_groups, stat_code, na_rm](const auto& sp_mat) -> NumericMatrix {
+    if(group.size() != sp_mat.nrow){
+      throw std::range_error("The length of group must match the number of rows");
+    }
+    GroupIndex groups(group, n_groups);
+    NumericMatrix result(n_groups, sp_mat.ncol);
+    double* result_ptr = result.begin();
+    dispatch_group_stat(stat_code, na_rm, [&](auto init, auto statistic) -> void {
+      typedef decltype(init) Accumulator;
+      reduce_columns_by_row_group(sp_mat, groups, init, [result_ptr, &groups, statistic](const Accumulator& acc, R_len_t col) -> void {
+        double* out = result_ptr + (R_xlen_t) col * groups.n_groups;
+        for(int g = 0; g < groups.n_groups; ++g){
+          out[g] = statistic(acc, g, groups.size(g));
+        }
+      });
+    });
+    return result;
+  });
+}
@@ -3,92 +3,161 @@
 
 
 #include <Rcpp.h>
+#include <type_traits>
+#include "ColumnSpan.h"
 
 
+// The ties method and the NA handling of the rank functions are template
+// parameters, so that the inner loops do not compare strings.
+//  * TiesMethod: the rank of a group of tied values (see rank())
+//  * NaHandling: Keep gives NA's the rank NA, Last ranks them after all other
+//    values (in the order in which they appear)
+enum class TiesMethod { Average, Min, Max };
+enum class NaHandling { Keep, Last };
 
-// This function was originally copied from https://stackoverflow.com/a/47619503/604854
-template <typename R, typename VT, typename IT>
-std::vector<R> calculate_sparse_rank(VT vec, IT positions, int number_of_zeros,
-                                          std::string ties_method, std::string na_handling) {
-  int vec_size = vec.size();
-  int total_size = vec_size + number_of_zeros;
-  std::vector<R> result(total_size,0);
-  //sorted index
-  std::vector<size_t> indx(vec_size);
-  iota(indx.begin(),indx.end(),0);
-  sort(indx.begin(),indx.end(),[&vec](int i1, int i2){
-    if(Rcpp::NumericVector::is_na(vec[i1])) return false;
-    if(Rcpp::NumericVector::is_na(vec[i2])) return true;
+template<TiesMethod ties_method>
+using ties_method_tag = std::integral_constant<TiesMethod, ties_method>;
+
+template<NaHandling na_handling>
+using na_handling_tag = std::integral_constant<NaHandling, na_handling>;
+
+
+// Parse the arguments and call op with the corresponding tags
+template<typename Functor>
+void dispatch_rank_method(std::string ties_method, std::string na_handling, Functor op){
+  if(na_handling != "keep" && na_handling != "last"){
+    throw std::runtime_error("Unknown argument to na_handling: " + na_handling + ". Can only handle 'keep' and 'last'.");
+  }
+  bool keep = na_handling == "keep";
+  auto with_na_handling = [&](auto ties_tag) -> void {
+    if(keep){
+      op(ties_tag, na_handling_tag<NaHandling::Keep>());
+    }else{
+      op(ties_tag, na_handling_tag<NaHandling::Last>());
+    }
+  };
+  if(ties_method == "average"){
+    with_na_handling(ties_method_tag<TiesMethod::Average>());
+  }else if(ties_method == "min"){
+    with_na_handling(ties_method_tag<TiesMethod::Min>());
+  }else if(ties_method == "max"){
+    with_na_handling(ties_method_tag<TiesMethod::Max>());
+  }else{
+    throw std::runtime_error("Unknown argument to ties_method: " + ties_method + ". Can only handle 'average', 'min', and 'max'.");
+  }
+}
+
+
+// The rank of a group of n tied values that starts at the (0-based)
+// position start of the sorted vector
+template<TiesMethod ties_method>
+inline double tied_rank(R_len_t start, R_len_t n){
+  if(ties_method == TiesMethod::Average){
+    return start + (n + 1) / 2.0;
+  }else if(ties_method == TiesMethod::Min){
+    return start + 1;
+  }else{
+    return start + n;
+  }
+}
+
+
+// The rank that all zeros of a column share (the implicit ones and the
+// stored zeros). It only depends on the number of negative values, so it
+// is found without sorting.
+template<TiesMethod ties_method, typename VT>
+double sparse_zero_rank(const VT& vec, int number_of_zeros){
+  R_len_t n_negative = 0;
+  R_len_t n_stored_zeros = 0;
+  for(double v : vec){
+    n_negative += v < 0;
+    n_stored_zeros += v == 0;
+  }
+  return tied_rank<ties_method>(n_negative, number_of_zeros + n_stored_zeros);
+}
+
+
+// Ranks the stored values of a sparse column with number_of_zeros implicit
+// zeros. Only the stored values are sorted (O(nnz log nnz)), the zeros form a
+// single block of ties that shifts the ranks of the positive values by
+// number_of_zeros. Calls zero_rank_found(rank) with the rank of the zeros
+// once it is known, then emit(k, rank) for each stored value vec[k] (the rank
+// is NA_REAL for NA's with NaHandling::Keep), and returns the rank of the zeros.
+template<TiesMethod ties_method, NaHandling na_handling, typename VT, typename Z, typename F>
+double rank_sparse_column(const VT& vec, int number_of_zeros, Z zero_rank_found, F emit){
+  R_len_t vec_size = vec.size();
+  thread_local std::vector<R_len_t> indx;
+  indx.clear();
+  for(R_len_t k = 0; k < vec_size; ++k){
+    if(! ISNAN(vec[k])){
+      indx.push_back(k);
+    }
+  }
+  R_len_t n_values = indx.size();
+  std::sort(indx.begin(), indx.end(), [&vec](R_len_t i1, R_len_t i2) -> bool {
     return vec[i1] < vec[i2];
   });
+  R_len_t zero_begin = std::partition_point(indx.begin(), indx.end(), [&vec](R_len_t i) -> bool {
+    return vec[i] < 0;
+  }) - indx.begin();
+  R_len_t zero_end = std::partition_point(indx.begin() + zero_begin, indx.end(), [&vec](R_len_t i) -> bool {
+    return vec[i] == 0;
+  }) - indx.begin();
+  double zero_rank = tied_rank<ties_method>(zero_begin, number_of_zeros + zero_end - zero_begin);
+  zero_rank_found(zero_rank);
 
-  // rank observed values
-  bool left_of_zero = vec_size > 0 && vec[indx[0]] < 0;
-  int zero_start_rank = 1;
-  for(int n, i=0;i < vec_size; i += n){
-    // This n stuff is for resolving ties.
-    // https://stackoverflow.com/a/30827731/604854
+  for(R_len_t i = 0, n; i < n_values; i += n){
     n = 1;
-    while(i + n < vec_size && vec[indx[i]] == vec[indx[i + n]]){
+    while(i + n < n_values && vec[indx[i]] == vec[indx[i + n]]){
       ++n;
     }
-    if(!left_of_zero){
-      for(int k = 0; k < n; ++k){
-        if(ties_method == "average"){
-          result[positions[indx[i+k]]] = i+number_of_zeros + (n + 1)/2.0;
-        }else if(ties_method == "min"){
-          result[positions[indx[i+k]]] = i+number_of_zeros + 1;
-        }else if(ties_method == "max"){
-          result[positions[indx[i+k]]] = i+number_of_zeros + n;
-        }else{
-          throw std::runtime_error("Unknown argument to ties_method: " + ties_method + ". Can only handle 'average', 'min', and 'max'.");
-        }
-      }
-    }
-    if(left_of_zero){
-      for(int k = 0; k < n; ++k){
-        if(ties_method == "average"){
-          result[positions[indx[i+k]]] = i+ (n + 1)/2.0;
-        }else if(ties_method == "min"){
-          result[positions[indx[i+k]]] = i+ 1;
-        }else if(ties_method == "max"){
-          result[positions[indx[i+k]]] = i+ n;
-        }else{
-          throw std::runtime_error("Unknown argument to ties_method: " + ties_method + ". Can only handle 'average', 'min', and 'max'.");
-        }
-      }
-      if(i + n  == vec_size || vec[indx[i + n]] > 0 || Rcpp::NumericVector::is_na(vec[indx[i + n]])){
-        left_of_zero = false;
-        zero_start_rank = i + n + 1;
-      }else{
-      }
-    }
-  }
-
-  std::vector<size_t> zero_pos(number_of_zeros);
-  std::vector<size_t> all_indices(total_size);
-  iota(all_indices.begin(),all_indices.end(),0);
-  std::set_difference(all_indices.begin(), all_indices.end(), positions.begin(), positions.end(), zero_pos.begin());
-  for(int zp: zero_pos){
-    if(ties_method == "average"){
-      result[zp] = (zero_start_rank * 2 - 1 + number_of_zeros) / 2.0;
-    }else if(ties_method == "min"){
-      result[zp] = zero_start_rank;
-    }else if(ties_method == "max"){
-      result[zp] = zero_start_rank + number_of_zeros - 1;
-    }else{
-      throw std::runtime_error("Unknown argument to ties_method: " + ties_method + ". Can only handle 'average', 'min', and 'max'.");
+    double rank = i < zero_begin ? tied_rank<ties_method>(i, n) :
+      i < zero_end ? zero_rank : tied_rank<ties_method>(i + number_of_zeros, n);
+    for(R_len_t k = 0; k < n; ++k){
+      emit(indx[i + k], rank);
     }
   }
-  if(na_handling == "keep"){
-    for(int i = 0; i < vec_size; ++i){
-      if(Rcpp::NumericVector::is_na(vec[i])){
-        result[positions[i]] = NA_REAL;
+  if(n_values < vec_size){
+    R_len_t rank = n_values + number_of_zeros;
+    for(R_len_t k = 0; k < vec_size; ++k){
+      if(ISNAN(vec[k])){
+        emit(k, na_handling == NaHandling::Keep ? NA_REAL : (double) ++rank);
       }
     }
   }
+  return zero_rank;
+}
 
-  return result;
+template<TiesMethod ties_method, NaHandling na_handling, typename VT, typename F>
+double rank_sparse_column(const VT& vec, int number_of_zeros, F emit){
+  return rank_sparse_column<ties_method, na_handling>(vec, number_of_zeros, [](double) -> void {}, emit);
+}
+
+
+template<typename T>
+inline T rank_as(double rank){
+  return rank;
+}
+
+template<>
+inline int rank_as<int>(double rank){
+  return ISNAN(rank) ? NA_INTEGER : (int) rank;
+}
+
+
+// The ranks of all elements of the column (the stored values at positions
+// plus number_of_zeros zeros) are written to result, which must have
+// vec.size() + number_of_zeros elements (e.g. an OutputSpan into the result
+// matrix).
+template <TiesMethod ties_method, NaHandling na_handling, typename VT, typename IT, typename T>
+void calculate_sparse_rank(const VT& vec, const IT& positions, int number_of_zeros, OutputSpan<T> result) {
+  // The stored values are usually few, so the zero rank is written everywhere
+  // as soon as it is known and then overwritten
+  rank_sparse_column<ties_method, na_handling>(vec, number_of_zeros, [&](double zero_rank) -> void {
+    result.fill(rank_as<T>(zero_rank));
+  }, [&](R_len_t k, double rank) -> void {
+    result[positions[k]] = rank_as<T>(rank);
+  });
 }
 
 
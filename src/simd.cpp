@@ -0,0 +1,416 @@
+#include <Rcpp.h>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include "simd.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define SIMD_X86_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+// AVX-512 implies FMA and GCC would fuse the multiplications and additions,
+// which changes the rounding compared to the other implementations.
+#if defined(__GNUC__) && ! defined(__clang__)
+#define SIMD_NO_CONTRACT __attribute__((optimize("fp-contract=off")))
+#else
+#define SIMD_NO_CONTRACT
+#endif
+
+
+// Number of independent accumulators. Every implementation below uses
+// exactly these lanes: element i always goes into lane i % SIMD_LANES.
+#define SIMD_LANES 8
+
+// Cody-Waite split of log(2) and the Taylor coefficients 1/k! for exp(r), |r| <= log(2)/2
+static const double LOG2E = 1.44269504088896338700e+00;
+static const double LN2_HI = 6.93147180369123816490e-01;
+static const double LN2_LO = 1.90821492927058770002e-10;
+static const double EXP_MIN_ARG = -708.0;
+static const double EXP_MAX_ARG = 709.0;
+static const double EXP_COEF[14] = {
+  1.0, 1.0, 1.0 / 2, 1.0 / 6, 1.0 / 24, 1.0 / 120, 1.0 / 720, 1.0 / 5040, 1.0 / 40320,
+  1.0 / 362880, 1.0 / 3628800, 1.0 / 39916800, 1.0 / 479001600, 1.0 / 6227020800
+};
+
+
+/*---------------Scalar building blocks-----------------*/
+
+// Knuth's TwoSum: sum + err == s + x exactly
+static inline void two_sum_add(double& s, double& c, double x){
+  double t = s + x;
+  double z = t - s;
+  c += (s - (t - z)) + (x - z);
+  s = t;
+}
+
+static inline double exp_scalar(double x){
+  x = std::min(std::max(x, EXP_MIN_ARG), EXP_MAX_ARG);
+  double n = std::nearbyint(x * LOG2E);
+  double r = x - n * LN2_HI;
+  r = r - n * LN2_LO;
+  double p = EXP_COEF[13];
+  for(int k = 12; k >= 0; --k){
+    p = p * r + EXP_COEF[k];
+  }
+  int64_t bits = ((int64_t) n + 1023) << 52;
+  double scale;
+  std::memcpy(&scale, &bits, sizeof(double));
+  return p * scale;
+}
+
+// Combine the lanes and the remaining elements in a fixed order
+static inline double finish_compensated(const double* sums, const double* comps, double tail_sum, double tail_comp){
+  double s = 0.0;
+  double c = 0.0;
+  for(int k = 0; k < SIMD_LANES; ++k){
+    two_sum_add(s, c, sums[k]);
+  }
+  for(int k = 0; k < SIMD_LANES; ++k){
+    c += comps[k];
+  }
+  two_sum_add(s, c, tail_sum);
+  c += tail_comp;
+  if(! R_FINITE(s)){
+    return s;
+  }
+  return s + c;
+}
+
+
+/*---------------Portable implementation-----------------*/
+
+static void sum_lanes_generic(const double* x, R_len_t n, double* sums, double* comps){
+  for(R_len_t i = 0; i < n; i += SIMD_LANES){
+    for(int k = 0; k < SIMD_LANES; ++k){
+      two_sum_add(sums[k], comps[k], x[i + k]);
+    }
+  }
+}
+
+static void sqdev_lanes_generic(const double* x, R_len_t n, double center, double* sums, double* comps){
+  for(R_len_t i = 0; i < n; i += SIMD_LANES){
+    for(int k = 0; k < SIMD_LANES; ++k){
+      double d = x[i + k] - center;
+      two_sum_add(sums[k], comps[k], d * d);
+    }
+  }
+}
+
+static void exp_lanes_generic(const double* x, R_len_t n, double shift, double* sums){
+  for(R_len_t i = 0; i < n; i += SIMD_LANES){
+    for(int k = 0; k < SIMD_LANES; ++k){
+      sums[k] += exp_scalar(x[i + k] - shift);
+    }
+  }
+}
+
+
+#ifdef SIMD_X86_DISPATCH
+
+/*---------------SSE2-----------------*/
+
+__attribute__((target("sse2"))) SIMD_NO_CONTRACT
+static inline void two_sum_add_sse2(__m128d& s, __m128d& c, __m128d x){
+  __m128d t = _mm_add_pd(s, x);
+  __m128d z = _mm_sub_pd(t, s);
+  c = _mm_add_pd(c, _mm_add_pd(_mm_sub_pd(s, _mm_sub_pd(t, z)), _mm_sub_pd(x, z)));
+  s = t;
+}
+
+__attribute__((target("sse2"))) SIMD_NO_CONTRACT
+static inline __m128d exp_sse2(__m128d x){
+  x = _mm_min_pd(_mm_max_pd(x, _mm_set1_pd(EXP_MIN_ARG)), _mm_set1_pd(EXP_MAX_ARG));
+  __m128i n_int = _mm_cvtpd_epi32(_mm_mul_pd(x, _mm_set1_pd(LOG2E)));
+  __m128d n = _mm_cvtepi32_pd(n_int);
+  __m128d r = _mm_sub_pd(x, _mm_mul_pd(n, _mm_set1_pd(LN2_HI)));
+  r = _mm_sub_pd(r, _mm_mul_pd(n, _mm_set1_pd(LN2_LO)));
+  __m128d p = _mm_set1_pd(EXP_COEF[13]);
+  for(int k = 12; k >= 0; --k){
+    p = _mm_add_pd(_mm_mul_pd(p, r), _mm_set1_pd(EXP_COEF[k]));
+  }
+  __m128i biased = _mm_add_epi32(n_int, _mm_set1_epi32(1023));
+  __m128i bits = _mm_slli_epi64(_mm_unpacklo_epi32(biased, _mm_setzero_si128()), 52);
+  return _mm_mul_pd(p, _mm_castsi128_pd(bits));
+}
+
+__attribute__((target("sse2"))) SIMD_NO_CONTRACT
+static void sum_lanes_sse2(const double* x, R_len_t n, double* sums, double* comps){
+  __m128d s[4], c[4];
+  for(int v = 0; v < 4; ++v){
+    s[v] = _mm_setzero_pd();
+    c[v] = _mm_setzero_pd();
+  }
+  for(R_len_t i = 0; i < n; i += SIMD_LANES){
+    for(int v = 0; v < 4; ++v){
+      two_sum_add_sse2(s[v], c[v], _mm_loadu_pd(x + i + 2 * v));
+    }
+  }
+  for(int v = 0; v < 4; ++v){
+    _mm_storeu_pd(sums + 2 * v, s[v]);
+    _mm_storeu_pd(comps + 2 * v, c[v]);
+  }
+}
+
+__attribute__((target("sse2"))) SIMD_NO_CONTRACT
+static void sqdev_lanes_sse2(const double* x, R_len_t n, double center, double* sums, double* comps){
+  __m128d s[4], c[4];
+  for(int v = 0; v < 4; ++v){
+    s[v] = _mm_setzero_pd();
+    c[v] = _mm_setzero_pd();
+  }
+  __m128d center_v = _mm_set1_pd(center);
+  for(R_len_t i = 0; i < n; i += SIMD_LANES){
+    for(int v = 0; v < 4; ++v){
+      __m128d d = _mm_sub_pd(_mm_loadu_pd(x + i + 2 * v), center_v);
+      two_sum_add_sse2(s[v], c[v], _mm_mul_pd(d, d));
+    }
+  }
+  for(int v = 0; v < 4; ++v){
+    _mm_storeu_pd(sums + 2 * v, s[v]);
+    _mm_storeu_pd(comps + 2 * v, c[v]);
+  }
+}
+
+__attribute__((target("sse2"))) SIMD_NO_CONTRACT
+static void exp_lanes_sse2(const double* x, R_len_t n, double shift, double* sums){
+  __m128d s[4];
+  for(int v = 0; v < 4; ++v){
+    s[v] = _mm_setzero_pd();
+  }
+  __m128d shift_v = _mm_set1_pd(shift);
+  for(R_len_t i = 0; i < n; i += SIMD_LANES){
+    for(int v = 0; v < 4; ++v){
+      s[v] = _mm_add_pd(s[v], exp_sse2(_mm_sub_pd(_mm_loadu_pd(x + i + 2 * v), shift_v)));
+    }
+  }
+  for(int v = 0; v < 4; ++v){
+    _mm_storeu_pd(sums + 2 * v, s[v]);
+  }
+}
+
+
+/*---------------AVX2-----------------*/
+
+__attribute__((target("avx2"))) SIMD_NO_CONTRACT
+static inline void two_sum_add_avx2(__m256d& s, __m256d& c, __m256d x){
+  __m256d t = _mm256_add_pd(s, x);
+  __m256d z = _mm256_sub_pd(t, s);
+  c = _mm256_add_pd(c, _mm256_add_pd(_mm256_sub_pd(s, _mm256_sub_pd(t, z)), _mm256_sub_pd(x, z)));
+  s = t;
+}
+
+__attribute__((target("avx2"))) SIMD_NO_CONTRACT
+static inline __m256d exp_avx2(__m256d x){
+  x = _mm256_min_pd(_mm256_max_pd(x, _mm256_set1_pd(EXP_MIN_ARG)), _mm256_set1_pd(EXP_MAX_ARG));
+  __m256d n = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(LOG2E)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  __m256d r = _mm256_sub_pd(x, _mm256_mul_pd(n, _mm256_set1_pd(LN2_HI)));
+  r = _mm256_sub_pd(r, _mm256_mul_pd(n, _mm256_set1_pd(LN2_LO)));
+  __m256d p = _mm256_set1_pd(EXP_COEF[13]);
+  for(int k = 12; k >= 0; --k){
+    p = _mm256_add_pd(_mm256_mul_pd(p, r), _mm256_set1_pd(EXP_COEF[k]));
+  }
+  __m128i biased = _mm_add_epi32(_mm256_cvtpd_epi32(n), _mm_set1_epi32(1023));
+  __m256i bits = _mm256_slli_epi64(_mm256_cvtepi32_epi64(biased), 52);
+  return _mm256_mul_pd(p, _mm256_castsi256_pd(bits));
+}
+
+__attribute__((target("avx2"))) SIMD_NO_CONTRACT
+static void sum_lanes_avx2(const double* x, R_len_t n, double* sums, double* comps){
+  __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+  __m256d c0 = _mm256_setzero_pd(), c1 = _mm256_setzero_pd();
+  for(R_len_t i = 0; i < n; i += SIMD_LANES){
+    two_sum_add_avx2(s0, c0, _mm256_loadu_pd(x + i));
+    two_sum_add_avx2(s1, c1, _mm256_loadu_pd(x + i + 4));
+  }
+  _mm256_storeu_pd(sums, s0);
+  _mm256_storeu_pd(sums + 4, s1);
+  _mm256_storeu_pd(comps, c0);
+  _mm256_storeu_pd(comps + 4, c1);
+}
+
+__attribute__((target("avx2"))) SIMD_NO_CONTRACT
+static void sqdev_lanes_avx2(const double* x, R_len_t n, double center, double* sums, double* comps){
+  __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+  __m256d c0 = _mm256_setzero_pd(), c1 = _mm256_setzero_pd();
+  __m256d center_v = _mm256_set1_pd(center);
+  for(R_len_t i = 0; i < n; i += SIMD_LANES){
+    __m256d d0 = _mm256_sub_pd(_mm256_loadu_pd(x + i), center_v);
+    __m256d d1 = _mm256_sub_pd(_mm256_loadu_pd(x + i + 4), center_v);
+    two_sum_add_avx2(s0, c0, _mm256_mul_pd(d0, d0));
+    two_sum_add_avx2(s1, c1, _mm256_mul_pd(d1, d1));
+  }
+  _mm256_storeu_pd(sums, s0);
+  _mm256_storeu_pd(sums + 4, s1);
+  _mm256_storeu_pd(comps, c0);
+  _mm256_storeu_pd(comps + 4, c1);
+}
+
+__attribute__((target("avx2"))) SIMD_NO_CONTRACT
+static void exp_lanes_avx2(const double* x, R_len_t n, double shift, double* sums){
+  __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+  __m256d shift_v = _mm256_set1_pd(shift);
+  for(R_len_t i = 0; i < n; i += SIMD_LANES){
+    s0 = _mm256_add_pd(s0, exp_avx2(_mm256_sub_pd(_mm256_loadu_pd(x + i), shift_v)));
+    s1 = _mm256_add_pd(s1, exp_avx2(_mm256_sub_pd(_mm256_loadu_pd(x + i + 4), shift_v)));
+  }
+  _mm256_storeu_pd(sums, s0);
+  _mm256_storeu_pd(sums + 4, s1);
+}
+
+
+/*---------------AVX-512-----------------*/
+
+__attribute__((target("avx512f"))) SIMD_NO_CONTRACT
+static inline void two_sum_add_avx512(__m512d& s, __m512d& c, __m512d x){
+  __m512d t = _mm512_add_pd(s, x);
+  __m512d z = _mm512_sub_pd(t, s);
+  c = _mm512_add_pd(c, _mm512_add_pd(_mm512_sub_pd(s, _mm512_sub_pd(t, z)), _mm512_sub_pd(x, z)));
+  s = t;
+}
+
+// The unmasked forms of max, min, roundscale, and the conversions / shifts
+// expand to _mm512_undefined_*(), which GCC reports as maybe uninitialized.
+// The zero-masked forms with all lanes selected compute the same.
+__attribute__((target("avx512f"))) SIMD_NO_CONTRACT
+static inline __m512d exp_avx512(__m512d x){
+  const __mmask8 all = 0xFF;
+  x = _mm512_maskz_min_pd(all, _mm512_maskz_max_pd(all, x, _mm512_set1_pd(EXP_MIN_ARG)), _mm512_set1_pd(EXP_MAX_ARG));
+  __m512d n = _mm512_maskz_roundscale_pd(all, _mm512_mul_pd(x, _mm512_set1_pd(LOG2E)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+  __m512d r = _mm512_sub_pd(x, _mm512_mul_pd(n, _mm512_set1_pd(LN2_HI)));
+  r = _mm512_sub_pd(r, _mm512_mul_pd(n, _mm512_set1_pd(LN2_LO)));
+  __m512d p = _mm512_set1_pd(EXP_COEF[13]);
+  for(int k = 12; k >= 0; --k){
+    p = _mm512_add_pd(_mm512_mul_pd(p, r), _mm512_set1_pd(EXP_COEF[k]));
+  }
+  __m256i biased = _mm256_add_epi32(_mm512_maskz_cvtpd_epi32(all, n), _mm256_set1_epi32(1023));
+  __m512i bits = _mm512_maskz_slli_epi64(all, _mm512_maskz_cvtepi32_epi64(all, biased), 52);
+  return _mm512_mul_pd(p, _mm512_castsi512_pd(bits));
+}
+
+__attribute__((target("avx512f"))) SIMD_NO_CONTRACT
+static void sum_lanes_avx512(const double* x, R_len_t n, double* sums, double* comps){
+  __m512d s = _mm512_setzero_pd(), c = _mm512_setzero_pd();
+  for(R_len_t i = 0; i < n; i += SIMD_LANES){
+    two_sum_add_avx512(s, c, _mm512_loadu_pd(x + i));
+  }
+  _mm512_storeu_pd(sums, s);
+  _mm512_storeu_pd(comps, c);
+}
+
+__attribute__((target("avx512f"))) SIMD_NO_CONTRACT
+static void sqdev_lanes_avx512(const double* x, R_len_t n, double center, double* sums, double* comps){
+  __m512d s = _mm512_setzero_pd(), c = _mm512_setzero_pd();
+  __m512d center_v = _mm512_set1_pd(center);
+  for(R_len_t i = 0; i < n; i += SIMD_LANES){
+    __m512d d = _mm512_sub_pd(_mm512_loadu_pd(x + i), center_v);
+    two_sum_add_avx512(s, c, _mm512_mul_pd(d, d));
+  }
+  _mm512_storeu_pd(sums, s);
+  _mm512_storeu_pd(comps, c);
+}
+
+__attribute__((target("avx512f"))) SIMD_NO_CONTRACT
+static void exp_lanes_avx512(const double* x, R_len_t n, double shift, double* sums){
+  __m512d s = _mm512_setzero_pd();
+  __m512d shift_v = _mm512_set1_pd(shift);
+  for(R_len_t i = 0; i < n; i += SIMD_LANES){
+    s = _mm512_add_pd(s, exp_avx512(_mm512_sub_pd(_mm512_loadu_pd(x + i), shift_v)));
+  }
+  _mm512_storeu_pd(sums, s);
+}
+
+#endif /* SIMD_X86_DISPATCH */
+
+
+/*---------------Dispatch-----------------*/
+
+// The lane functions process the first n elements, n is a multiple of SIMD_LANES
+struct SimdKernels {
+  void (*sum)(const double*, R_len_t, double*, double*);
+  void (*sqdev)(const double*, R_len_t, double, double*, double*);
+  void (*exp)(const double*, R_len_t, double, double*);
+};
+
+static SimdKernels select_simd_kernels(){
+#ifdef SIMD_X86_DISPATCH
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("avx512f")){
+    return SimdKernels{sum_lanes_avx512, sqdev_lanes_avx512, exp_lanes_avx512};
+  }else if(__builtin_cpu_supports("avx2")){
+    return SimdKernels{sum_lanes_avx2, sqdev_lanes_avx2, exp_lanes_avx2};
+  }else if(__builtin_cpu_supports("sse2")){
+    return SimdKernels{sum_lanes_sse2, sqdev_lanes_sse2, exp_lanes_sse2};
+  }
+#endif
+  return SimdKernels{sum_lanes_generic, sqdev_lanes_generic, exp_lanes_generic};
+}
+
+static const SimdKernels& simd_kernels(){
+  static const SimdKernels kernels = select_simd_kernels();
+  return kernels;
+}
+
+
+// A NaN result can come from an NA or from Inf - Inf. Report NA if
+// there is any NA, as R does.
+static double na_or_nan(const double* x, R_len_t n){
+  for(R_len_t i = 0; i < n; ++i){
+    if(R_IsNA(x[i])){
+      return NA_REAL;
+    }
+  }
+  return R_NaN;
+}
+
+
+double simd_sum(const double* x, R_len_t n){
+  double sums[SIMD_LANES] = {0};
+  double comps[SIMD_LANES] = {0};
+  R_len_t n_lanes = n - n % SIMD_LANES;
+  simd_kernels().sum(x, n_lanes, sums, comps);
+  double tail_sum = 0.0;
+  double tail_comp = 0.0;
+  for(R_len_t i = n_lanes; i < n; ++i){
+    two_sum_add(tail_sum, tail_comp, x[i]);
+  }
+  double result = finish_compensated(sums, comps, tail_sum, tail_comp);
+  if(ISNAN(result)){
+    return na_or_nan(x, n);
+  }
+  return result;
+}
+
+
+double simd_sum_squared_deviations(const double* x, R_len_t n, double center){
+  double sums[SIMD_LANES] = {0};
+  double comps[SIMD_LANES] = {0};
+  R_len_t n_lanes = n - n % SIMD_LANES;
+  simd_kernels().sqdev(x, n_lanes, center, sums, comps);
+  double tail_sum = 0.0;
+  double tail_comp = 0.0;
+  for(R_len_t i = n_lanes; i < n; ++i){
+    double d = x[i] - center;
+    two_sum_add(tail_sum, tail_comp, d * d);
+  }
+  double result = finish_compensated(sums, comps, tail_sum, tail_comp);
+  if(ISNAN(result)){
+    return na_or_nan(x, n);
+  }
+  return result;
+}
+
+
+double simd_sum_exp(const double* x, R_len_t n, double shift){
+  double sums[SIMD_LANES] = {0};
+  R_len_t n_lanes = n - n % SIMD_LANES;
+  simd_kernels().exp(x, n_lanes, shift, sums);
+  double result = 0.0;
+  for(int k = 0; k < SIMD_LANES; ++k){
+    result += sums[k];
+  }
+  for(R_len_t i = n_lanes; i < n; ++i){
+    result += exp_scalar(x[i] - shift);
+  }
+  return result;
+}
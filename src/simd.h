@@ -0,0 +1,24 @@
+#ifndef simd_h
+#define simd_h
+
+#include <Rinternals.h>
+
+
+// Vectorized kernels for the simple column aggregations. At the first call,
+// the best implementation for the CPU is selected (AVX-512, AVX2, SSE2 or
+// plain C++ on other architectures).
+// All implementations use the same eight accumulation lanes and process the
+// elements in the same order, so the results do not depend on the CPU.
+
+// Compensated (TwoSum) sum of x[0], ..., x[n-1]. If the result is not finite,
+// the plain sum is returned (NA if any element is NA).
+double simd_sum(const double* x, R_len_t n);
+
+// Compensated sum of (x[i] - center)^2
+double simd_sum_squared_deviations(const double* x, R_len_t n, double center);
+
+// Sum of exp(x[i] - shift). Assumes that x[i] <= shift and that there are no NaN's.
+double simd_sum_exp(const double* x, R_len_t n, double shift);
+
+
+#endif /* simd_h */
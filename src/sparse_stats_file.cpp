@@ -0,0 +1,318 @@
+#include <Rcpp.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+#include "SparseMatrixView.h"
+#include "sparse_stats_file.h"
+#include "parallel.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace Rcpp;
+
+
+
+// A column-compressed matrix in a file that is memory-mapped, so that the
+// statistics run directly over the pages of the file. Only the pages that a
+// kernel touches are read, and they stay in the page cache for the next call
+// (the mapping is kept open as long as the SparseStatsFile exists).
+//
+// Layout of the file (native byte order):
+//   bytes  0 -  7  magic "SMSCSC01"
+//   bytes  8 - 31  nrow, ncol, nnz (uint64)
+//   bytes 32 - 35  byte order mark (uint32, 1)
+//   bytes 36 - 63  reserved (zero)
+//   ncol + 1 doubles with the column pointers (like the p slot of a
+//     dgCMatrix with a long x slot, see SparseMatrixView.h)
+//   nnz int32 with the row indices, padded with zeros to a multiple of 8 bytes
+//   nnz doubles with the values
+// The arrays are aligned to 8 bytes, so the views can point into the mapping.
+// On Windows the file is read into memory instead.
+
+static const char sparse_stats_file_magic[8] = {'S', 'M', 'S', 'C', 'S', 'C', '0', '1'};
+static const size_t sparse_stats_file_header_size = 64;
+
+struct SparseStatsFileLayout {
+  uint64_t nrow;
+  uint64_t ncol;
+  uint64_t nnz;
+
+  uint64_t col_ptrs_offset() const {
+    return sparse_stats_file_header_size;
+  }
+
+  uint64_t row_indices_offset() const {
+    return col_ptrs_offset() + (ncol + 1) * sizeof(double);
+  }
+
+  uint64_t row_indices_padding() const {
+    return (nnz * sizeof(int32_t)) % 8 == 0 ? 0 : 4;
+  }
+
+  uint64_t values_offset() const {
+    return row_indices_offset() + nnz * sizeof(int32_t) + row_indices_padding();
+  }
+
+  uint64_t file_size() const {
+    return values_offset() + nnz * sizeof(double);
+  }
+};
+
+
+class SparseStatsFileMapping {
+public:
+  R_len_t nrow = 0;
+  R_len_t ncol = 0;
+  R_xlen_t nnz = 0;
+  const double* col_ptrs = nullptr;
+  const int* row_indices = nullptr;
+  const double* values = nullptr;
+
+  explicit SparseStatsFileMapping(const std::string& path_): path(path_) {
+#ifndef _WIN32
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0){
+      throw std::runtime_error("Cannot open '" + path + "': " + std::strerror(errno));
+    }
+    struct stat info;
+    if(fstat(fd, &info) != 0){
+      int error = errno;
+      close(fd);
+      throw std::runtime_error("Cannot open '" + path + "': " + std::strerror(error));
+    }
+    length = (size_t) info.st_size;
+    if(length < sparse_stats_file_header_size){
+      close(fd);
+      throw std::runtime_error("'" + path + "' is not a sparse stats file (it is too short)");
+    }
+    void* mapped = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    // The mapping stays valid after the file descriptor is closed
+    close(fd);
+    if(mapped == MAP_FAILED){
+      throw std::runtime_error("Cannot map '" + path + "' into memory: " + std::strerror(errno));
+    }
+    address = mapped;
+#else
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if(file == nullptr){
+      throw std::runtime_error("Cannot open '" + path + "': " + std::strerror(errno));
+    }
+    std::fseek(file, 0, SEEK_END);
+    long size = std::ftell(file);
+    std::fseek(file, 0, SEEK_SET);
+    if(size < (long) sparse_stats_file_header_size){
+      std::fclose(file);
+      throw std::runtime_error("'" + path + "' is not a sparse stats file (it is too short)");
+    }
+    length = (size_t) size;
+    // Doubles are 8-byte aligned in the buffer as well
+    buffer.resize((length + 7) / 8);
+    address = buffer.data();
+    bool complete = std::fread(address, 1, length, file) == length;
+    std::fclose(file);
+    if(! complete){
+      throw std::runtime_error("Cannot read '" + path + "'");
+    }
+#endif
+    try{
+      read_header();
+    }catch(...){
+      // The destructor does not run if the constructor throws
+      unmap();
+      throw;
+    }
+  }
+
+  ~SparseStatsFileMapping(){
+    unmap();
+  }
+
+  SparseStatsFileMapping(const SparseStatsFileMapping&) = delete;
+  SparseStatsFileMapping& operator=(const SparseStatsFileMapping&) = delete;
+
+  // Tells the kernel how the arrays are going to be read. Sequential
+  // access enables an aggressive read-ahead, otherwise the default is used
+  // (a column subset jumps between the columns, but reads each of them
+  // front to back).
+  void advise(bool sequential){
+#ifndef _WIN32
+    int advice = sequential ? MADV_SEQUENTIAL : MADV_NORMAL;
+    if(advice != current_advice){
+      madvise(address, length, advice);
+      current_advice = advice;
+    }
+#endif
+  }
+
+  // Checks that the arrays form a valid matrix: the column pointers start at
+  // 0, do not decrease, and end at nnz, and the row indices are within
+  // bounds and strictly increasing in each column. Reads all column pointers
+  // and row indices once.
+  void check() const {
+    if(col_ptrs[0] != 0 || col_ptrs[ncol] != (double) nnz){
+      throw std::runtime_error("'" + path + "' is corrupt: invalid column pointers");
+    }
+    for(R_len_t col = 0; col < ncol; ++col){
+      double size = col_ptrs[col + 1] - col_ptrs[col];
+      if(! (size >= 0 && size <= nrow) || col_ptrs[col + 1] != (double) (R_xlen_t) col_ptrs[col + 1]){
+        throw std::runtime_error("'" + path + "' is corrupt: invalid column pointers");
+      }
+    }
+    bool valid = true;
+#ifdef _OPENMP
+    #pragma omp parallel for num_threads(get_n_threads()) reduction(&&:valid) schedule(dynamic, 64)
+#endif
+    for(R_len_t col = 0; col < ncol; ++col){
+      int previous = -1;
+      for(R_xlen_t i = (R_xlen_t) col_ptrs[col]; i < (R_xlen_t) col_ptrs[col + 1]; ++i){
+        int row = row_indices[i];
+        if(row <= previous || row >= nrow){
+          valid = false;
+          break;
+        }
+        previous = row;
+      }
+    }
+    if(! valid){
+      throw std::runtime_error("'" + path + "' is corrupt: invalid row indices");
+    }
+  }
+
+private:
+  const std::string path;
+  void* address = nullptr;
+  size_t length = 0;
+  int current_advice = -1;
+#ifdef _WIN32
+  std::vector<double> buffer;
+#endif
+
+  void unmap(){
+#ifndef _WIN32
+    if(address != nullptr){
+      munmap(address, length);
+      address = nullptr;
+    }
+#endif
+  }
+
+  void read_header(){
+    const char* bytes = (const char*) address;
+    if(std::memcmp(bytes, sparse_stats_file_magic, sizeof(sparse_stats_file_magic)) != 0){
+      throw std::runtime_error("'" + path + "' is not a sparse stats file");
+    }
+    SparseStatsFileLayout layout;
+    uint32_t byte_order;
+    std::memcpy(&layout.nrow, bytes + 8, sizeof(uint64_t));
+    std::memcpy(&layout.ncol, bytes + 16, sizeof(uint64_t));
+    std::memcpy(&layout.nnz, bytes + 24, sizeof(uint64_t));
+    std::memcpy(&byte_order, bytes + 32, sizeof(uint32_t));
+    if(byte_order != 1){
+      throw std::runtime_error("'" + path + "' was written on a machine with a different byte order");
+    }
+    if(layout.nrow > (uint64_t) std::numeric_limits<int>::max() || layout.ncol > (uint64_t) std::numeric_limits<int>::max() ||
+       layout.nnz > ((uint64_t) 1 << 52) || layout.file_size() != (uint64_t) length){
+      throw std::runtime_error("'" + path + "' is corrupt: the size of the file does not match its header");
+    }
+    nrow = (R_len_t) layout.nrow;
+    ncol = (R_len_t) layout.ncol;
+    nnz = (R_xlen_t) layout.nnz;
+    col_ptrs = (const double*) (bytes + layout.col_ptrs_offset());
+    row_indices = (const int*) (bytes + layout.row_indices_offset());
+    values = (const double*) (bytes + layout.values_offset());
+  }
+};
+
+
+bool is_sparse_stats_file(Rcpp::S4 sp_mat){
+  return sp_mat.is("SparseStatsFile");
+}
+
+
+dgCMatrixView wrap_sparse_stats_file(Rcpp::S4 file, bool sequential){
+  SEXP mapping = file.slot("mapping");
+  if(TYPEOF(mapping) != EXTPTRSXP || R_ExternalPtrAddr(mapping) == nullptr){
+    throw std::runtime_error("The file of the SparseStatsFile is not mapped (e.g. because the object was saved and loaded again). Open it again with openSparseStatsFile()");
+  }
+  SparseStatsFileMapping* file_mapping = (SparseStatsFileMapping*) R_ExternalPtrAddr(mapping);
+  file_mapping->advise(sequential);
+  return dgCMatrixView(file_mapping->nrow, file_mapping->ncol, file_mapping->values,
+                       file_mapping->row_indices, file_mapping->col_ptrs, mapping);
+}
+
+
+
+// Writes matrix (a dgCMatrix, or a SparseStatsFile) in the layout above
+// [[Rcpp::export]]
+void write_sparse_stats_file(S4 matrix, std::string path){
+  dgCMatrixView sp_mat = wrap_dgCMatrix(matrix);
+  SparseStatsFileLayout layout;
+  layout.nrow = sp_mat.nrow;
+  layout.ncol = sp_mat.ncol;
+  layout.nnz = sp_mat.col_ptr(sp_mat.ncol);
+
+  std::FILE* file = std::fopen(path.c_str(), "wb");
+  if(file == nullptr){
+    throw std::runtime_error("Cannot open '" + path + "' for writing: " + std::strerror(errno));
+  }
+  char header[sparse_stats_file_header_size] = {0};
+  uint32_t byte_order = 1;
+  std::memcpy(header, sparse_stats_file_magic, sizeof(sparse_stats_file_magic));
+  std::memcpy(header + 8, &layout.nrow, sizeof(uint64_t));
+  std::memcpy(header + 16, &layout.ncol, sizeof(uint64_t));
+  std::memcpy(header + 24, &layout.nnz, sizeof(uint64_t));
+  std::memcpy(header + 32, &byte_order, sizeof(uint32_t));
+  bool ok = std::fwrite(header, 1, sizeof(header), file) == sizeof(header);
+
+  // The column pointers are converted to double in blocks
+  std::vector<double> col_ptrs_block;
+  col_ptrs_block.reserve(4096);
+  for(R_len_t col = 0; ok && col <= sp_mat.ncol; ++col){
+    col_ptrs_block.push_back((double) sp_mat.col_ptr(col));
+    if(col_ptrs_block.size() == col_ptrs_block.capacity() || col == sp_mat.ncol){
+      ok = std::fwrite(col_ptrs_block.data(), sizeof(double), col_ptrs_block.size(), file) == col_ptrs_block.size();
+      col_ptrs_block.clear();
+    }
+  }
+  const int32_t zero_padding = 0;
+  if(layout.nnz > 0){
+    ok = ok && std::fwrite(sp_mat.row_indices_ptr, sizeof(int32_t), layout.nnz, file) == layout.nnz;
+    ok = ok && std::fwrite(&zero_padding, 1, layout.row_indices_padding(), file) == layout.row_indices_padding();
+    ok = ok && std::fwrite(sp_mat.values_ptr, sizeof(double), layout.nnz, file) == layout.nnz;
+  }
+  ok = (std::fclose(file) == 0) && ok;
+  if(! ok){
+    std::remove(path.c_str());
+    throw std::runtime_error("Cannot write '" + path + "'");
+  }
+}
+
+
+// Maps the file at path. Returns the external pointer to the mapping (which
+// is released by the finalizer) and the dimensions of the matrix. If check is
+// true, the arrays are validated first (see SparseStatsFileMapping::check()).
+// [[Rcpp::export]]
+List open_sparse_stats_file(std::string path, bool check){
+  std::unique_ptr<SparseStatsFileMapping> file_mapping(new SparseStatsFileMapping(path));
+  if(check){
+    file_mapping->check();
+  }
+  R_len_t nrow = file_mapping->nrow;
+  R_len_t ncol = file_mapping->ncol;
+  double nnz = (double) file_mapping->nnz;
+  XPtr<SparseStatsFileMapping> mapping(file_mapping.release(), true);
+  return List::create(Named("mapping") = mapping,
+                      Named("nrow") = wrap(nrow),
+                      Named("ncol") = wrap(ncol),
+                      Named("nnz") = wrap(nnz));
+}
@@ -0,0 +1,15 @@
+#ifndef sparse_stats_file_h
+#define sparse_stats_file_h
+
+#include <Rcpp.h>
+#include "SparseMatrixView.h"
+
+// A view on the matrix in the file that is mapped by a SparseStatsFile (see
+// sparse_stats_file.cpp). The view keeps the mapping alive. sequential is a
+// hint for the kernel: the columns are read front to back (otherwise only
+// some of them are read, in any order).
+// Throws a std::runtime_error if the mapping is no longer valid (e.g. the
+// object was saved and loaded again).
+dgCMatrixView wrap_sparse_stats_file(Rcpp::S4 file, bool sequential);
+
+#endif /* sparse_stats_file_h */
@@ -0,0 +1,332 @@
+#ifndef summary_stats_h
+#define summary_stats_h
+
+#include <Rcpp.h>
+#include <string>
+#include <vector>
+#include "ColumnSpan.h"
+#include "NaPolicy.h"
+#include "my_utils.h"
+#include "simd.h"
+#include "types.h"
+
+
+// The statistics that colSummary() / rowSummary() can compute in one go.
+// Each has the same semantics as the corresponding single function:
+// sum (colSums2), mean (colMeans2), var (colVars), min (colMins),
+// max (colMaxs), nnz (number of non-zero entries, NA's are not counted
+// with na.rm = TRUE), and anyNA (colAnyNAs, ignores na.rm).
+enum class SummaryStat { Sum, Mean, Var, Min, Max, Nnz, AnyNA };
+
+
+inline std::vector<SummaryStat> parse_summary_stats(Rcpp::CharacterVector stats){
+  std::vector<std::string> stat_names = Rcpp::as<std::vector<std::string> >(stats);
+  std::vector<SummaryStat> result;
+  result.reserve(stat_names.size());
+  for(const std::string& stat : stat_names){
+    if(stat == "sum"){
+      result.push_back(SummaryStat::Sum);
+    }else if(stat == "mean"){
+      result.push_back(SummaryStat::Mean);
+    }else if(stat == "var"){
+      result.push_back(SummaryStat::Var);
+    }else if(stat == "min"){
+      result.push_back(SummaryStat::Min);
+    }else if(stat == "max"){
+      result.push_back(SummaryStat::Max);
+    }else if(stat == "nnz"){
+      result.push_back(SummaryStat::Nnz);
+    }else if(stat == "anyNA"){
+      result.push_back(SummaryStat::AnyNA);
+    }else{
+      throw std::runtime_error("Unknown statistic: " + stat + ". Can only handle 'sum', 'mean', 'var', 'min', 'max', 'nnz', and 'anyNA'.");
+    }
+  }
+  return result;
+}
+
+
+inline bool needs_summary_stat(const std::vector<SummaryStat>& stats, SummaryStat stat){
+  return std::find(stats.begin(), stats.end(), stat) != stats.end();
+}
+
+
+struct SummaryResult {
+  double sum = 0.0;
+  double mean = 0.0;
+  double var = 0.0;
+  double min = R_PosInf;
+  double max = R_NegInf;
+  double nnz = 0.0;
+  bool any_na = false;
+
+  double get(SummaryStat stat) const {
+    switch(stat){
+    case SummaryStat::Sum: return sum;
+    case SummaryStat::Mean: return mean;
+    case SummaryStat::Var: return var;
+    case SummaryStat::Min: return min;
+    case SummaryStat::Max: return max;
+    case SummaryStat::Nnz: return nnz;
+    case SummaryStat::AnyNA: return any_na;
+    }
+    return NA_REAL;
+  }
+};
+
+
+// Sum of the squared deviations from center, vectorized for double columns.
+template<NaPolicy na_policy>
+inline double sum_squared_deviations(const ColumnSpan<double, na_policy>& values, double center){
+  return simd_sum_squared_deviations(values.begin(), values.size(), center);
+}
+
+template<NaPolicy na_policy>
+inline double sum_squared_deviations(const ColumnSpan<int, na_policy>& values, double center){
+  LDOUBLE sum = 0.0;
+  for(int e : values){
+    sum += (e - center) * (e - center);
+  }
+  return sum;
+}
+
+
+// Summarize one column. min, max, nnz, and anyNA come from a single
+// loop over the values, sum / mean / var reuse the vectorized kernels on
+// the same (now cache resident) values. raw_size is the number of stored
+// elements before the NA's were removed.
+template<typename T, NaPolicy na_policy>
+inline SummaryResult summarize_column(const ColumnSpan<T, na_policy>& values, R_len_t number_of_zeros,
+                                      R_len_t raw_size, bool need_sum, bool need_var){
+  SummaryResult res;
+  R_len_t size = values.size() + number_of_zeros;
+  R_len_t n_stored_zeros = 0;
+  bool has_na = false;
+  for(T e : values){
+    if(na_policy == NaPolicy::Propagate && is_na_value(e)){
+      has_na = true;
+      continue;
+    }
+    double v = e;
+    res.min = v < res.min ? v : res.min;
+    res.max = v > res.max ? v : res.max;
+    n_stored_zeros += v == 0.0;
+  }
+  if(number_of_zeros > 0){
+    res.min = std::min(res.min, 0.0);
+    res.max = std::max(res.max, 0.0);
+  }
+  if(has_na){
+    res.min = NA_REAL;
+    res.max = NA_REAL;
+    res.nnz = NA_REAL;
+  }else{
+    res.nnz = values.size() - n_stored_zeros;
+  }
+  res.any_na = has_na || values.size() != raw_size;
+
+  if(need_sum){
+    res.sum = sum_stable(values);
+    if(Rcpp::NumericVector::is_na(res.sum)){
+      res.mean = res.sum;
+    }else if(size == 0){
+      res.mean = R_NaN;
+    }else{
+      res.mean = res.sum / size;
+    }
+  }
+  if(need_var){
+    if(ISNA(res.mean)){
+      res.var = NA_REAL;
+    }else if(size <= 1){
+      res.var = NA_REAL;
+    }else{
+      double sigma2 = number_of_zeros * res.mean * res.mean +
+        sum_squared_deviations(values, res.mean);
+      res.var = sigma2 / (size - 1);
+    }
+  }
+  return res;
+}
+
+
+// The summary of the stored values of each row (or column) over all values
+// seen so far, for rowSummary() and the streaming functions
+// (rowStatsAccumulator() and mtxSummary()): the number of non-NA values, of NA's, and of stored zeros,
+// the sum (including the NA's if ! na_rm), the min / max, and the mean / m2
+// of the non-NA values relative to shift (the first value of the row, see
+// RowVarAccumulator in row_methods.cpp). The values of a row can be added in
+// any order. The implicit zeros are only added when the result is
+// calculated, so two summaries are combined with Chan et al.'s update
+// regardless of how many values each of them covers.
+// Between calls from R, the summary is stored in a numeric matrix with one
+// column per field (count, nas, stored_zeros, sum, min, max, shift, mean, m2).
+struct RowMomentAccumulator {
+  bool na_rm;
+  std::vector<double> count;
+  std::vector<double> nas;
+  std::vector<double> stored_zeros;
+  std::vector<LDOUBLE> sum;
+  std::vector<double> min;
+  std::vector<double> max;
+  std::vector<double> shift;
+  std::vector<LDOUBLE> mean;
+  std::vector<LDOUBLE> m2;
+
+  static const int state_fields = 9;
+
+  explicit RowMomentAccumulator(bool na_rm_): na_rm(na_rm_) {}
+
+  static const size_t bytes_per_row = 6 * sizeof(double) + 3 * sizeof(LDOUBLE);
+
+  void reset(R_len_t row_begin, R_len_t n_rows){
+    count.assign(n_rows, 0.0);
+    nas.assign(n_rows, 0.0);
+    stored_zeros.assign(n_rows, 0.0);
+    sum.assign(n_rows, 0.0);
+    min.assign(n_rows, R_PosInf);
+    max.assign(n_rows, R_NegInf);
+    shift.assign(n_rows, 0.0);
+    mean.assign(n_rows, 0.0);
+    m2.assign(n_rows, 0.0);
+  }
+
+  void add(R_len_t row, double v){
+    if(ISNAN(v)){
+      nas[row] += 1;
+      if(! na_rm){
+        sum[row] += v;
+      }
+      return;
+    }
+    sum[row] += v;
+    min[row] = v < min[row] ? v : min[row];
+    max[row] = v > max[row] ? v : max[row];
+    stored_zeros[row] += v == 0.0;
+    double n = ++count[row];
+    if(n == 1){
+      shift[row] = v;
+    }
+    LDOUBLE x = (LDOUBLE) v - shift[row];
+    LDOUBLE delta = x - mean[row];
+    mean[row] += delta / n;
+    m2[row] += delta * (x - mean[row]);
+  }
+
+  // Combine the rows of other with the rows [offset, offset + size) of this
+  void merge_rows(const RowMomentAccumulator& other, R_len_t offset){
+    for(size_t k = 0; k < other.count.size(); ++k){
+      size_t row = offset + k;
+      nas[row] += other.nas[k];
+      stored_zeros[row] += other.stored_zeros[k];
+      sum[row] += other.sum[k];
+      min[row] = std::min(min[row], other.min[k]);
+      max[row] = std::max(max[row], other.max[k]);
+      double n_other = other.count[k];
+      if(n_other == 0){
+        continue;
+      }
+      if(count[row] == 0){
+        shift[row] = other.shift[k];
+        mean[row] = other.mean[k];
+        m2[row] = other.m2[k];
+      }else{
+        double n = count[row] + n_other;
+        LDOUBLE delta = ((LDOUBLE) other.shift[k] - shift[row]) + (other.mean[k] - mean[row]);
+        m2[row] += other.m2[k] + delta * delta * count[row] * n_other / n;
+        mean[row] += delta * n_other / n;
+      }
+      count[row] += n_other;
+    }
+  }
+
+  void merge(const RowMomentAccumulator& other){
+    merge_rows(other, 0);
+  }
+
+  void read_state(const NumericMatrix& state){
+    if(state.ncol() != state_fields){
+      throw std::range_error("The state of the accumulator is corrupted");
+    }
+    R_len_t n_rows = state.nrow();
+    const double* ptr = state.begin();
+    count.assign(ptr, ptr + n_rows);
+    nas.assign(ptr + n_rows, ptr + 2 * n_rows);
+    stored_zeros.assign(ptr + 2 * n_rows, ptr + 3 * n_rows);
+    sum.assign(ptr + 3 * n_rows, ptr + 4 * n_rows);
+    min.assign(ptr + 4 * n_rows, ptr + 5 * n_rows);
+    max.assign(ptr + 5 * n_rows, ptr + 6 * n_rows);
+    shift.assign(ptr + 6 * n_rows, ptr + 7 * n_rows);
+    mean.assign(ptr + 7 * n_rows, ptr + 8 * n_rows);
+    m2.assign(ptr + 8 * n_rows, ptr + 9 * n_rows);
+  }
+
+  NumericMatrix state() const {
+    R_len_t n_rows = count.size();
+    NumericMatrix result(n_rows, state_fields);
+    double* ptr = result.begin();
+    std::copy(count.begin(), count.end(), ptr);
+    std::copy(nas.begin(), nas.end(), ptr + n_rows);
+    std::copy(stored_zeros.begin(), stored_zeros.end(), ptr + 2 * n_rows);
+    std::copy(sum.begin(), sum.end(), ptr + 3 * n_rows);
+    std::copy(min.begin(), min.end(), ptr + 4 * n_rows);
+    std::copy(max.begin(), max.end(), ptr + 5 * n_rows);
+    std::copy(shift.begin(), shift.end(), ptr + 6 * n_rows);
+    std::copy(mean.begin(), mean.end(), ptr + 7 * n_rows);
+    std::copy(m2.begin(), m2.end(), ptr + 8 * n_rows);
+    return result;
+  }
+
+  // The statistics of a row that spans n_cols columns, with the same
+  // semantics as rowSummary()
+  SummaryResult summary(R_len_t row, double n_cols) const {
+    SummaryResult res;
+    double number_of_zeros = n_cols - count[row] - nas[row];
+    double size = na_rm ? n_cols - nas[row] : n_cols;
+    bool propagate_na = ! na_rm && nas[row] > 0;
+    res.sum = sum[row];
+    if(ISNAN(res.sum)){
+      res.mean = res.sum;
+    }else if(size == 0){
+      res.mean = R_NaN;
+    }else{
+      res.mean = res.sum / size;
+    }
+    if(propagate_na || size <= 1){
+      res.var = NA_REAL;
+    }else{
+      LDOUBLE m2_total = 0.0;
+      if(count[row] > 0){
+        LDOUBLE mu = shift[row] + mean[row];
+        m2_total = m2[row] + mu * mu * count[row] * number_of_zeros / (count[row] + number_of_zeros);
+      }
+      res.var = m2_total / (size - 1);
+    }
+    res.min = number_of_zeros > 0 ? std::min(min[row], 0.0) : min[row];
+    res.max = number_of_zeros > 0 ? std::max(max[row], 0.0) : max[row];
+    res.nnz = count[row] - stored_zeros[row];
+    if(propagate_na){
+      res.min = NA_REAL;
+      res.max = NA_REAL;
+      res.nnz = NA_REAL;
+    }
+    res.any_na = nas[row] > 0;
+    return res;
+  }
+
+  // Writes the statistics of the rows [0, n_rows) to the rows
+  // [row_begin, row_begin + n_rows) of a column-major matrix with result_nrow
+  // rows and one column per entry of stat_codes
+  void write_summaries(R_len_t n_rows, double n_cols, const std::vector<SummaryStat>& stat_codes,
+                       double* result_ptr, R_len_t row_begin, R_len_t result_nrow) const {
+    for(R_len_t row = 0; row < n_rows; ++row){
+      SummaryResult res = summary(row, n_cols);
+      for(size_t k = 0; k < stat_codes.size(); ++k){
+        result_ptr[row_begin + row + (R_xlen_t) k * result_nrow] = res.get(stat_codes[k]);
+      }
+    }
+  }
+};
+
+
+#endif /* summary_stats_h */
@@ -0,0 +1,86 @@
+#ifndef top_k_h
+#define top_k_h
+
+
+#include <Rcpp.h>
+#include "ColumnSpan.h"
+#include "types.h"
+#include <vector>
+#include <algorithm>
+
+using namespace Rcpp;
+
+// Per-thread heap for top_k_sparse
+inline std::vector<std::pair<double, int> >& top_k_buffer(){
+  thread_local std::vector<std::pair<double, int> > buffer;
+  return buffer;
+}
+
+// The k largest (Decreasing) or smallest elements of a sparse column with
+// nrow rows in order, ties are broken by the row. So the rows are the same as
+// head(order(x, decreasing = Decreasing, na.last = NA), k).
+// The stored non-zero elements go through a bounded heap of size k
+// (O(nnz log k)), the heap front is the worst element that is kept. The zeros
+// (stored ones and the rows that are not in row_indices, which have to be
+// increasing) sit between the positive and negative elements and are only
+// enumerated as far as they are needed. NA's are skipped.
+// Writes the values and the (1-based) rows of the first
+// min(k, number of non-NA elements) entries and returns their number.
+template<bool Decreasing, typename ValueSpan, typename IndexSpan>
+R_len_t top_k_sparse(const ValueSpan& values, const IndexSpan& row_indices, R_len_t nrow, R_len_t k,
+                     OutputSpan<double> out_values, OutputSpan<int> out_rows){
+  auto better = [](const std::pair<double, int>& a, const std::pair<double, int>& b) -> bool {
+    if(a.first != b.first){
+      return Decreasing ? a.first > b.first : a.first < b.first;
+    }
+    return a.second < b.second;
+  };
+  std::vector<std::pair<double, int> >& heap = top_k_buffer();
+  heap.clear();
+  R_len_t size = values.size();
+  if(k > 0){
+    for(R_len_t i = 0; i < size; ++i){
+      double v = values[i];
+      if(ISNAN(v) || v == 0){
+        continue;
+      }
+      std::pair<double, int> entry(v, row_indices[i]);
+      if((R_len_t) heap.size() < k){
+        heap.push_back(entry);
+        std::push_heap(heap.begin(), heap.end(), better);
+      }else if(better(entry, heap.front())){
+        std::pop_heap(heap.begin(), heap.end(), better);
+        heap.back() = entry;
+        std::push_heap(heap.begin(), heap.end(), better);
+      }
+    }
+  }
+  std::sort_heap(heap.begin(), heap.end(), better);
+
+  R_len_t n = 0;
+  size_t h = 0;
+  auto emit = [&n, &out_values, &out_rows](double value, int row) -> void {
+    out_values[n] = value;
+    out_rows[n] = row + 1;
+    ++n;
+  };
+  for(; h < heap.size() && n < k && (Decreasing ? heap[h].first > 0 : heap[h].first < 0); ++h){
+    emit(heap[h].first, heap[h].second);
+  }
+  R_len_t pos = 0;
+  for(int row = 0; row < nrow && n < k; ++row){
+    while(pos < size && row_indices[pos] < row){
+      ++pos;
+    }
+    if(pos >= size || row_indices[pos] != row || values[pos] == 0){
+      emit(0.0, row);
+    }
+  }
+  for(; h < heap.size() && n < k; ++h){
+    emit(heap[h].first, heap[h].second);
+  }
+  return n;
+}
+
+
+#endif /* top_k_h */
@@ -16,8 +16,15 @@
 #endif
 
 
-/* Macro to check for user interrupts every 2^20 iteration */
+/* Macro to check for user interrupts every 2^20 iteration.
+   R_CheckUserInterrupt() is not thread-safe, so it is skipped inside
+   of a parallel region. */
+#ifdef _OPENMP
+#include <omp.h>
+#define R_CHECK_USER_INTERRUPT(i) if (i % 1048576 == 0 && ! omp_in_parallel()) R_CheckUserInterrupt()
+#else
 #define R_CHECK_USER_INTERRUPT(i) if (i % 1048576 == 0) R_CheckUserInterrupt()
+#endif
 
 
 